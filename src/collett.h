@@ -62,6 +62,55 @@ enum ItemLevel {
     NoteLevel    = 4,
 };
 
+// Project Model Roles
+// Custom data roles of the project model. They are the same for all columns.
+enum ProjectRole {
+    ItemLevelRole         = Qt::UserRole + 1,
+    ItemActiveRole        = Qt::UserRole + 2,
+    SubTreeWordsRole      = Qt::UserRole + 3,
+    SubTreeCharactersRole = Qt::UserRole + 4,
+};
+
+// Child Sort Keys
+// Used for sorting the children of a project node.
+enum SortKey {
+    SortByName  = 0,
+    SortByWords = 1,
+};
+
+// Project Filter
+// Selects project nodes by class, level and active status. The masks have one
+// bit per enum value, and an empty mask matches everything. Levels only apply
+// to file nodes.
+struct NodeFilter {
+    quint32 classMask  = 0;
+    quint32 levelMask  = 0;
+    bool    activeOnly = false;
+
+    bool isEmpty() const {return classMask == 0 && levelMask == 0 && !activeOnly;};
+};
+
+// Node Counts
+// The text counts of a project item, or of a part of its text.
+struct NodeCounts {
+    qint32 characters;
+    qint32 words;
+    qint32 paragraphs;
+
+    NodeCounts &operator+=(const NodeCounts &other) {
+        characters += other.characters;
+        words += other.words;
+        paragraphs += other.paragraphs;
+        return *this;
+    };
+    NodeCounts &operator-=(const NodeCounts &other) {
+        characters -= other.characters;
+        words -= other.words;
+        paragraphs -= other.paragraphs;
+        return *this;
+    };
+};
+
 // Theme Colours
 // Used as index keys to look up colours from the Theme class.
 enum ThemeColor {
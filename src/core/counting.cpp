@@ -0,0 +1,389 @@
+/*
+** Collett – Text Counting Functions
+** =================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "counting.h"
+
+#include <QByteArrayView>
+#include <QChar>
+#include <QString>
+#include <QStringView>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COUNTING_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Collett {
+
+// Header markup is plain ASCII, so the same check works for both encodings
+template <typename T>
+static int markupLevel(const T *data, qsizetype length) {
+    int level = 0;
+    while (level < length && level < 5 && data[level] == '#') {
+        level++;
+    }
+    if (level > 4 || level >= length || data[level] != ' ') {
+        return 0;
+    }
+    return level;
+}
+
+static inline bool isWordSplit(char32_t ucs4) {
+    return QChar::isSpace(ucs4) || ucs4 == 0x2013 || ucs4 == 0x2014;
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Count a text of one or more paragraphs.
+ *
+ * @param text       The text, with paragraphs separated by newlines.
+ * @return NodeCounts The summed counts of all paragraphs.
+ */
+NodeCounts Counting::countText(QStringView text) {
+    NodeCounts counts = {0, 0, 0};
+    qsizetype start = 0;
+    while (start <= text.size()) {
+        qsizetype end = text.indexOf(u'\n', start);
+        if (end < 0) end = text.size();
+        counts += Counting::countParagraph(text.sliced(start, end - start));
+        start = end + 1;
+    }
+    return counts;
+}
+
+/**!
+ * @brief Count a UTF-8 encoded text of one or more paragraphs.
+ *
+ * This counts the raw file content, so it does not need to be decoded.
+ *
+ * @param text       The text, with paragraphs separated by newlines.
+ * @return NodeCounts The summed counts of all paragraphs.
+ */
+NodeCounts Counting::countUtf8(QByteArrayView text) {
+    const Utf8Kernel kernel = Counting::kernels().utf8;
+    const uchar *data = reinterpret_cast<const uchar*>(text.data());
+    NodeCounts counts = {0, 0, 0};
+    qsizetype start = 0;
+    while (start <= text.size()) {
+        qsizetype end = text.indexOf('\n', start);
+        if (end < 0) end = text.size();
+        qsizetype length = end - start;
+        if (length > 0 && data[start + length - 1] == '\r') length--;
+
+        int level = markupLevel(data + start, length);
+        qsizetype skip = level > 0 ? level + 1 : 0;
+        qint32 chars = 0;
+        qint32 words = kernel(data + start + skip, length - skip, chars);
+        counts.characters += chars;
+        counts.words += words;
+        counts.paragraphs += level == 0 && words > 0 ? 1 : 0;
+        start = end + 1;
+    }
+    return counts;
+}
+
+/**!
+ * @brief Count a single paragraph.
+ *
+ * Header markup is not counted, and headers are not counted as paragraphs.
+ * A word is a run of characters between white space or dashes.
+ *
+ * @param text       The paragraph text, without the newline.
+ * @return NodeCounts The counts of the paragraph.
+ */
+NodeCounts Counting::countParagraph(QStringView text) {
+    NodeCounts counts = {0, 0, 0};
+    int level = Counting::headerLevel(text);
+    if (level > 0) {
+        text = text.sliced(level + 1);
+    }
+
+    qint32 surrogates = 0;
+    counts.words = Counting::kernels().utf16(text.utf16(), text.size(), surrogates);
+    counts.characters = static_cast<qint32>(text.size()) - surrogates;
+    counts.paragraphs = level == 0 && counts.words > 0 ? 1 : 0;
+    return counts;
+}
+
+/**!
+ * @brief Get the header level of a paragraph.
+ *
+ * A header is a paragraph starting with one to four hashes and a space.
+ *
+ * @param text The paragraph text.
+ * @return int The header level, or 0 for a plain paragraph.
+ */
+int Counting::headerLevel(QStringView text) {
+    return markupLevel(text.utf16(), text.size());
+}
+
+const char *Counting::kernelName() {
+    return Counting::kernels().name;
+}
+
+// Kernel Dispatch
+// ===============
+
+/**!
+ * @brief Select the counting kernels for this CPU.
+ *
+ * The choice is made once, on first use.
+ */
+const Counting::Kernels &Counting::kernels() {
+    static const Kernels selected = []() -> Kernels {
+#ifdef COUNTING_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return {&Counting::wordsAvx2Utf16, &Counting::wordsAvx2Utf8, "AVX2"};
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return {&Counting::wordsSse2Utf16, &Counting::wordsSse2Utf8, "SSE2"};
+        }
+#endif
+        return {&Counting::wordsScalar16, &Counting::wordsScalar8, "Scalar"};
+    }();
+    return selected;
+}
+
+// Scalar Kernels
+// ==============
+
+qint32 Counting::wordsScalar16(const char16_t *data, qsizetype length, qint32 &surrogates) {
+    bool inWord = false;
+    qint32 words = 0;
+    Counting::scan16(data, 0, length, inWord, words, surrogates);
+    return words;
+}
+
+qint32 Counting::wordsScalar8(const uchar *data, qsizetype length, qint32 &chars) {
+    bool inWord = false;
+    qint32 words = 0;
+    Counting::scan8(data, 0, length, length, inWord, words, chars);
+    return words;
+}
+
+/**!
+ * @brief Count words in a range of UTF-16 text, following Unicode rules.
+ *
+ * There are no white space or dash characters outside the BMP, so the
+ * surrogates do not need to be paired up.
+ */
+qsizetype Counting::scan16(
+    const char16_t *data, qsizetype pos, qsizetype end, bool &inWord, qint32 &words, qint32 &surrogates
+) {
+    for (; pos < end; ++pos) {
+        char16_t c = data[pos];
+        bool split = isWordSplit(c);
+        words += !split && !inWord;
+        surrogates += QChar::isLowSurrogate(c);
+        inWord = !split;
+    }
+    return pos;
+}
+
+/**!
+ * @brief Count words in a range of UTF-8 text, following Unicode rules.
+ *
+ * Whole code points are decoded, so the returned position may be past the
+ * end of the range, but never past the length of the text. Invalid bytes
+ * count as one character each.
+ */
+qsizetype Counting::scan8(
+    const uchar *data, qsizetype pos, qsizetype end, qsizetype length, bool &inWord, qint32 &words, qint32 &chars
+) {
+    while (pos < end) {
+        uchar b = data[pos];
+        char32_t ucs4 = b;
+        qsizetype size = 1;
+        if (b >= 0xf0 && b < 0xf8) {
+            size = 4;
+            ucs4 = b & 0x07;
+        } else if (b >= 0xe0) {
+            size = b < 0xf0 ? 3 : 1;
+            ucs4 = b & 0x0f;
+        } else if (b >= 0xc0) {
+            size = 2;
+            ucs4 = b & 0x1f;
+        }
+        if (size > 1 && pos + size <= length) {
+            for (qsizetype i = 1; i < size; ++i) {
+                ucs4 = (ucs4 << 6) | (data[pos + i] & 0x3f);
+            }
+        } else if (b >= 0x80) {
+            size = 1;
+            ucs4 = QChar::ReplacementCharacter;
+        }
+        bool split = isWordSplit(ucs4);
+        words += !split && !inWord;
+        inWord = !split;
+        chars++;
+        pos += size;
+    }
+    return pos;
+}
+
+// Vector Kernels
+// ==============
+//
+// The vector kernels handle blocks of pure ASCII text, where white space is
+// space or one of the control characters 9 to 13. A word starts wherever a
+// non-space follows a space, which is found by shifting the non-space mask
+// by one and carrying the last bit over to the next block. Blocks with any
+// non-ASCII character are handed to the scalar code.
+
+#ifdef COUNTING_X86_KERNELS
+
+__attribute__((target("sse2")))
+qint32 Counting::wordsSse2Utf16(const char16_t *data, qsizetype length, qint32 &surrogates) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i high = _mm_set1_epi16(static_cast<short>(0xff80));
+    const __m128i space = _mm_set1_epi16(0x20);
+    const __m128i ctrlLo = _mm_set1_epi16(0x08);
+    const __m128i ctrlHi = _mm_set1_epi16(0x0e);
+
+    bool inWord = false;
+    qint32 words = 0;
+    qsizetype pos = 0;
+    for (; pos + 8 <= length; pos += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)) != 0xffff) {
+            Counting::scan16(data, pos, pos + 8, inWord, words, surrogates);
+            continue;
+        }
+        __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi16(v, ctrlLo), _mm_cmplt_epi16(v, ctrlHi));
+        __m128i split = _mm_or_si128(_mm_cmpeq_epi16(v, space), ctrl);
+        quint32 solid = ~static_cast<quint32>(_mm_movemask_epi8(_mm_packs_epi16(split, zero))) & 0xffu;
+        words += __builtin_popcount(solid & ~((solid << 1) | (inWord ? 1u : 0u)));
+        inWord = (solid >> 7) & 1u;
+    }
+    Counting::scan16(data, pos, length, inWord, words, surrogates);
+    return words;
+}
+
+__attribute__((target("sse2")))
+qint32 Counting::wordsSse2Utf8(const uchar *data, qsizetype length, qint32 &chars) {
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i ctrlLo = _mm_set1_epi8(0x08);
+    const __m128i ctrlHi = _mm_set1_epi8(0x0e);
+
+    bool inWord = false;
+    qint32 words = 0;
+    qsizetype pos = 0;
+    while (pos + 16 <= length) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        if (_mm_movemask_epi8(v) != 0) {
+            pos = Counting::scan8(data, pos, pos + 16, length, inWord, words, chars);
+            continue;
+        }
+        __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(v, ctrlLo), _mm_cmplt_epi8(v, ctrlHi));
+        __m128i split = _mm_or_si128(_mm_cmpeq_epi8(v, space), ctrl);
+        quint32 solid = ~static_cast<quint32>(_mm_movemask_epi8(split)) & 0xffffu;
+        words += __builtin_popcount(solid & ~((solid << 1) | (inWord ? 1u : 0u)));
+        inWord = (solid >> 15) & 1u;
+        chars += 16;
+        pos += 16;
+    }
+    Counting::scan8(data, pos, length, length, inWord, words, chars);
+    return words;
+}
+
+__attribute__((target("avx2")))
+qint32 Counting::wordsAvx2Utf16(const char16_t *data, qsizetype length, qint32 &surrogates) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i high = _mm256_set1_epi16(static_cast<short>(0xff80));
+    const __m256i space = _mm256_set1_epi16(0x20);
+    const __m256i ctrlLo = _mm256_set1_epi16(0x08);
+    const __m256i ctrlHi = _mm256_set1_epi16(0x0e);
+
+    bool inWord = false;
+    qint32 words = 0;
+    qsizetype pos = 0;
+    for (; pos + 16 <= length; pos += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, high), zero)) != -1) {
+            Counting::scan16(data, pos, pos + 16, inWord, words, surrogates);
+            continue;
+        }
+        __m256i ctrl = _mm256_and_si256(_mm256_cmpgt_epi16(v, ctrlLo), _mm256_cmpgt_epi16(ctrlHi, v));
+        __m256i split = _mm256_or_si256(_mm256_cmpeq_epi16(v, space), ctrl);
+
+        // Packing works within each 128-bit lane, leaving the two halves of
+        // the mask in bytes 0-7 and 16-23
+        quint32 packed = static_cast<quint32>(_mm256_movemask_epi8(_mm256_packs_epi16(split, zero)));
+        quint32 solid = ~((packed & 0xffu) | ((packed >> 8) & 0xff00u)) & 0xffffu;
+        words += __builtin_popcount(solid & ~((solid << 1) | (inWord ? 1u : 0u)));
+        inWord = (solid >> 15) & 1u;
+    }
+    Counting::scan16(data, pos, length, inWord, words, surrogates);
+    return words;
+}
+
+__attribute__((target("avx2")))
+qint32 Counting::wordsAvx2Utf8(const uchar *data, qsizetype length, qint32 &chars) {
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i ctrlLo = _mm256_set1_epi8(0x08);
+    const __m256i ctrlHi = _mm256_set1_epi8(0x0e);
+
+    bool inWord = false;
+    qint32 words = 0;
+    qsizetype pos = 0;
+    while (pos + 32 <= length) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        if (_mm256_movemask_epi8(v) != 0) {
+            pos = Counting::scan8(data, pos, pos + 32, length, inWord, words, chars);
+            continue;
+        }
+        __m256i ctrl = _mm256_and_si256(_mm256_cmpgt_epi8(v, ctrlLo), _mm256_cmpgt_epi8(ctrlHi, v));
+        __m256i split = _mm256_or_si256(_mm256_cmpeq_epi8(v, space), ctrl);
+        quint32 solid = ~static_cast<quint32>(_mm256_movemask_epi8(split));
+        words += __builtin_popcount(solid & ~((solid << 1) | (inWord ? 1u : 0u)));
+        inWord = (solid >> 31) & 1u;
+        chars += 32;
+        pos += 32;
+    }
+    Counting::scan8(data, pos, length, length, inWord, words, chars);
+    return words;
+}
+
+#else
+
+// Without x86 vector support, the scalar kernels are used throughout
+qint32 Counting::wordsSse2Utf16(const char16_t *data, qsizetype length, qint32 &surrogates) {
+    return Counting::wordsScalar16(data, length, surrogates);
+}
+
+qint32 Counting::wordsSse2Utf8(const uchar *data, qsizetype length, qint32 &chars) {
+    return Counting::wordsScalar8(data, length, chars);
+}
+
+qint32 Counting::wordsAvx2Utf16(const char16_t *data, qsizetype length, qint32 &surrogates) {
+    return Counting::wordsScalar16(data, length, surrogates);
+}
+
+qint32 Counting::wordsAvx2Utf8(const uchar *data, qsizetype length, qint32 &chars) {
+    return Counting::wordsScalar8(data, length, chars);
+}
+
+#endif
+
+} // namespace Collett
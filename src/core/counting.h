@@ -0,0 +1,73 @@
+/*
+** Collett – Text Counting Functions
+** =================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_COUNTING_H
+#define COLLETT_COUNTING_H
+
+#include "collett.h"
+
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+
+namespace Collett {
+
+class Counting
+{
+    // The kernel check and benchmark in utils/countbench.cpp
+    friend class CountingBench;
+
+public:
+    static NodeCounts countText(QStringView text);
+    static NodeCounts countUtf8(QByteArrayView text);
+    static NodeCounts countParagraph(QStringView text);
+    static int headerLevel(QStringView text);
+    static const char *kernelName();
+
+private:
+    // Counting Kernels
+    // Each kernel counts the words of a single line. The UTF-16 kernels also
+    // count low surrogates, and the UTF-8 kernels count code points, so that
+    // characters are counted the same way for both.
+    typedef qint32 (*Utf16Kernel)(const char16_t *data, qsizetype length, qint32 &surrogates);
+    typedef qint32 (*Utf8Kernel)(const uchar *data, qsizetype length, qint32 &chars);
+
+    struct Kernels {
+        Utf16Kernel utf16;
+        Utf8Kernel  utf8;
+        const char *name;
+    };
+
+    static const Kernels &kernels();
+
+    static qint32 wordsScalar16(const char16_t *data, qsizetype length, qint32 &surrogates);
+    static qint32 wordsScalar8(const uchar *data, qsizetype length, qint32 &chars);
+    static qint32 wordsSse2Utf16(const char16_t *data, qsizetype length, qint32 &surrogates);
+    static qint32 wordsSse2Utf8(const uchar *data, qsizetype length, qint32 &chars);
+    static qint32 wordsAvx2Utf16(const char16_t *data, qsizetype length, qint32 &surrogates);
+    static qint32 wordsAvx2Utf8(const uchar *data, qsizetype length, qint32 &chars);
+
+    static qsizetype scan16(const char16_t *data, qsizetype pos, qsizetype end, bool &inWord, qint32 &words, qint32 &surrogates);
+    static qsizetype scan8(const uchar *data, qsizetype pos, qsizetype end, qsizetype length, bool &inWord, qint32 &words, qint32 &chars);
+};
+} // namespace Collett
+
+#endif // COLLETT_COUNTING_H
@@ -0,0 +1,224 @@
+/*
+** Collett – Document File Class
+** =============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "docfile.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QString>
+#include <QStringDecoder>
+#include <QStringEncoder>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace Collett {
+
+// Constructor
+// ===========
+
+DocFile::DocFile(const QString &path) : m_path(path), m_hash(QCryptographicHash::Md5) {
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Read the document file.
+ *
+ * The file is decoded in chunks of DOCFILE_CHUNK_SIZE bytes. Header lines
+ * are consumed as they arrive, up to the end marker or the first line that
+ * is not a header line. The rest is appended to the text with
+ * line endings normalised to LF. A CR at the end of a chunk is held back
+ * until the next chunk shows whether it is part of a CRLF.
+ *
+ * @param text   Receives the document text.
+ * @return bool  True if the file was read.
+ */
+bool DocFile::read(QString &text) {
+    m_meta.clear();
+    m_size = 0;
+    m_hash.reset();
+    text.clear();
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_lastError = tr("Could not open file: %1").arg(m_path);
+        return false;
+    }
+    text.reserve(file.size());
+
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QByteArray buffer(DOCFILE_CHUNK_SIZE, Qt::Uninitialized);
+    QString pending;
+    bool header = true;
+    bool done = false;
+    while (!done) {
+        qint64 size = file.read(buffer.data(), DOCFILE_CHUNK_SIZE);
+        if (size < 0) {
+            m_lastError = tr("Could not read file: %1").arg(m_path);
+            return false;
+        }
+        done = size < DOCFILE_CHUNK_SIZE;
+        m_size += size;
+        m_hash.addData(QByteArrayView(buffer.constData(), size));
+
+        pending.append(decoder(QByteArrayView(buffer.constData(), size)));
+        qsizetype usable = pending.size();
+        if (!done && usable > 0 && pending.at(usable - 1) == u'\r') usable--;
+
+        QStringView chunk = QStringView(pending).first(usable);
+        while (header && !chunk.isEmpty()) {
+            if (chunk.size() < 3 && !done) break;
+            if (!chunk.startsWith("%%~"_L1)) {
+                header = false;
+                break;
+            }
+            qsizetype end = chunk.indexOf(u'\n');
+            if (end < 0 && !done) break;
+            QStringView line = end < 0 ? chunk : chunk.first(end);
+            if (line.endsWith(u'\r')) line.chop(1);
+            bool last = line == QLatin1StringView(DOCFILE_HEADER_END);
+            if (!last && !this->parseHeader(line)) {
+                header = false;
+                break;
+            }
+            chunk = end < 0 ? QStringView() : chunk.sliced(end + 1);
+            if (last) header = false;
+        }
+        if (header && !done) {
+            // Keep the partial header line for the next chunk
+            pending = chunk.toString() + QStringView(pending).sliced(usable);
+            continue;
+        }
+
+        if (chunk.contains(u'\r')) {
+            text.append(chunk.toString().replace("\r\n"_L1, "\n"_L1));
+        } else {
+            text.append(chunk);
+        }
+        pending = QStringView(pending).sliced(usable).toString();
+    }
+
+    if (decoder.hasError()) {
+        qWarning() << "Invalid UTF-8 in file:" << m_path;
+    }
+    return true;
+}
+
+/**!
+ * @brief Write the document file.
+ *
+ * The text is encoded and written one chunk at a time, and the file is only
+ * replaced once all of it has been written.
+ *
+ * @param chunks The document text, in order.
+ * @return bool  True if the file was written.
+ */
+bool DocFile::write(const QList<QStringView> &chunks) {
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_lastError = tr("Could not open file: %1").arg(m_path);
+        return false;
+    }
+
+    QByteArray header = "%%~collett: " DOCFILE_VERSION "\n";
+    for (auto it = m_meta.cbegin(); it != m_meta.cend(); ++it) {
+        if (it.key() == "collett"_L1) continue;
+        header.append("%%~" + it.key().toUtf8() + ": " + it.value().toUtf8() + "\n");
+    }
+    header.append(DOCFILE_HEADER_END "\n");
+    file.write(header);
+    m_size = header.size();
+    m_hash.reset();
+    m_hash.addData(header);
+
+    QStringEncoder encoder(QStringEncoder::Utf8);
+    for (const QStringView &chunk : chunks) {
+        QByteArray data = encoder(chunk);
+        file.write(data);
+        m_size += data.size();
+        m_hash.addData(data);
+    }
+
+    if (!file.commit()) {
+        m_lastError = tr("Could not write file: %1").arg(m_path);
+        return false;
+    }
+    return true;
+}
+
+void DocFile::setMeta(const QString &key, const QString &value) {
+    QString clean = value;
+    clean.replace(u'\n', u' ');
+    m_meta.insert(key, clean);
+}
+
+// Static Functions
+// ================
+
+/**!
+ * @brief Get the size of the metadata header in raw file data.
+ *
+ * This lets code that works on the raw bytes skip the header.
+ *
+ * @param data       The raw file data.
+ * @return qsizetype The number of bytes before the document text.
+ */
+qsizetype DocFile::headerSize(QByteArrayView data) {
+    if (!data.startsWith("%%~collett:")) return 0;
+    qsizetype pos = 0;
+    while (data.sliced(pos).startsWith("%%~")) {
+        qsizetype end = data.indexOf('\n', pos);
+        if (end < 0) end = data.size();
+        QByteArrayView line = data.sliced(pos, end - pos);
+        if (line.endsWith('\r')) line.chop(1);
+        if (line != DOCFILE_HEADER_END && !line.contains(':')) break;
+        pos = qMin(end + 1, data.size());
+        if (line == DOCFILE_HEADER_END) break;
+    }
+    return pos;
+}
+
+// Private Methods
+// ===============
+
+/**!
+ * @brief Parse a header line.
+ *
+ * The first line must be the format line written by write(), so that a
+ * file without a header never loses its first lines.
+ *
+ * @param line  The line, without the line break.
+ * @return bool False if the line is not a header line.
+ */
+bool DocFile::parseHeader(QStringView line) {
+    if (!line.startsWith("%%~"_L1)) return false;
+    qsizetype sep = line.indexOf(u':');
+    if (sep <= 3) return false;
+
+    QString key = line.sliced(3, sep - 3).trimmed().toString();
+    if (m_meta.isEmpty() && key != "collett"_L1) return false;
+    m_meta.insert(key, line.sliced(sep + 1).trimmed().toString());
+    return true;
+}
+
+} // namespace Collett
@@ -0,0 +1,89 @@
+/*
+** Collett – Document File Class
+** =============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_DOC_FILE_H
+#define COLLETT_DOC_FILE_H
+
+#include "collett.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringView>
+
+#define DOCFILE_CHUNK_SIZE 65536
+#define DOCFILE_VERSION "1.0"
+#define DOCFILE_HEADER_END "%%~end"
+
+namespace Collett {
+
+/**!
+ * @brief A document file in the project content folder.
+ *
+ * The file is UTF-8 plain text with markup. It starts with a metadata header
+ * of lines on the form "%%~key: value", beginning with the format line
+ * "%%~collett: <version>" and ending with the line "%%~end". The document
+ * text follows directly after. Files without a header are read as text
+ * only.
+ */
+class DocFile
+{
+    Q_DECLARE_TR_FUNCTIONS(DocFile)
+
+public:
+    explicit DocFile(const QString &path);
+    ~DocFile() {};
+
+    // Methods
+    bool read(QString &text);
+    bool write(const QList<QStringView> &chunks);
+
+    // Metadata
+    QString meta(const QString &key) const {return m_meta.value(key);};
+    void setMeta(const QString &key, const QString &value);
+
+    // The size and checksum of the raw file data of the last read or write
+    qint64 fileSize() const {return m_size;};
+    QByteArray checksum() const {return m_hash.result();};
+
+    // Error Handling
+    bool hasError() const {return !m_lastError.isEmpty();};
+    QString lastError() const {return m_lastError;};
+
+    // Static Functions
+    static qsizetype headerSize(QByteArrayView data);
+
+private:
+    QString m_path;
+    QMap<QString, QString> m_meta;
+    QString m_lastError = "";
+    qint64 m_size = 0;
+    QCryptographicHash m_hash;
+
+    bool parseHeader(QStringView line);
+};
+} // namespace Collett
+
+#endif // COLLETT_DOC_FILE_H
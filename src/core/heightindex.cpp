@@ -0,0 +1,143 @@
+/*
+** Collett – Height Index Class
+** ============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "heightindex.h"
+
+#include <QList>
+
+#include <algorithm>
+
+namespace Collett {
+
+// Public Methods
+// ==============
+
+void HeightIndex::clear() {
+    m_heights.clear();
+    m_tree.clear();
+    m_stale = false;
+}
+
+void HeightIndex::setHeights(const QList<qint32> &heights) {
+    m_heights = heights;
+    m_stale = true;
+}
+
+/**!
+ * @brief Set the height of a single line.
+ *
+ * @param line   The line number.
+ * @param height The new height.
+ */
+void HeightIndex::setHeight(qsizetype line, qint32 height) {
+    if (line < 0 || line >= m_heights.size()) return;
+    qint64 diff = height - m_heights.at(line);
+    if (diff == 0) return;
+    m_heights[line] = height;
+    if (m_stale) return;
+
+    qsizetype n = m_heights.size();
+    for (qsizetype i = line + 1; i <= n; i += i & -i) {
+        m_tree[i] += diff;
+    }
+}
+
+/**!
+ * @brief Replace a range of lines with new lines.
+ *
+ * @param line    The first line of the range.
+ * @param removed The number of lines to remove.
+ * @param heights The heights of the lines to insert in their place.
+ */
+void HeightIndex::replaceLines(qsizetype line, qsizetype removed, const QList<qint32> &heights) {
+    line = qBound<qsizetype>(0, line, m_heights.size());
+    removed = qBound<qsizetype>(0, removed, m_heights.size() - line);
+    if (removed == heights.size()) {
+        for (qsizetype i = 0; i < removed; ++i) {
+            this->setHeight(line + i, heights.at(i));
+        }
+        return;
+    }
+    m_heights.remove(line, removed);
+    m_heights.insert(line, heights.size(), 0);
+    std::copy(heights.cbegin(), heights.cend(), m_heights.begin() + line);
+    m_stale = true;
+}
+
+// Getters
+// =======
+
+/**!
+ * @brief Get the position of the top of a line.
+ *
+ * @param line    The line number.
+ * @return qint64 The sum of the heights of the lines before it.
+ */
+qint64 HeightIndex::top(qsizetype line) const {
+    if (m_stale) this->build();
+    line = qBound<qsizetype>(0, line, m_heights.size());
+
+    qint64 sum = 0;
+    for (qsizetype i = line; i > 0; i -= i & -i) {
+        sum += m_tree.at(i);
+    }
+    return sum;
+}
+
+/**!
+ * @brief Get the line at a position.
+ *
+ * @param y          The position from the top.
+ * @return qsizetype The line number, clamped to the valid lines.
+ */
+qsizetype HeightIndex::lineAt(qint64 y) const {
+    if (m_stale) this->build();
+    qsizetype n = m_heights.size();
+    if (n == 0) return 0;
+
+    qsizetype step = 1;
+    while (step * 2 <= n) step *= 2;
+
+    qsizetype pos = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= n && m_tree.at(pos + step) <= y) {
+            pos += step;
+            y -= m_tree.at(pos);
+        }
+    }
+    return qMin(pos, n - 1);
+}
+
+// Private Methods
+// ===============
+
+void HeightIndex::build() const {
+    qsizetype n = m_heights.size();
+    m_tree.fill(0, n + 1);
+    for (qsizetype i = 1; i <= n; ++i) {
+        m_tree[i] += m_heights.at(i - 1);
+        qsizetype j = i + (i & -i);
+        if (j <= n) m_tree[j] += m_tree.at(i);
+    }
+    m_stale = false;
+}
+
+} // namespace Collett
@@ -0,0 +1,67 @@
+/*
+** Collett – Height Index Class
+** ============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_HEIGHT_INDEX_H
+#define COLLETT_HEIGHT_INDEX_H
+
+#include "collett.h"
+
+#include <QList>
+
+namespace Collett {
+
+/**!
+ * @brief The heights of the lines of a document.
+ *
+ * The heights are kept in a Fenwick tree, so that the position of a line,
+ * and the line at a position, can be found in logarithmic time. Changing
+ * the number of lines only marks the tree as stale, and it is rebuilt in
+ * linear time on the next lookup.
+ */
+class HeightIndex
+{
+public:
+    HeightIndex() {};
+    ~HeightIndex() {};
+
+    // Methods
+    void clear();
+    void setHeights(const QList<qint32> &heights);
+    void setHeight(qsizetype line, qint32 height);
+    void replaceLines(qsizetype line, qsizetype removed, const QList<qint32> &heights);
+
+    // Getters
+    qsizetype count() const {return m_heights.size();};
+    qint32    height(qsizetype line) const {return m_heights.value(line, 0);};
+    qint64    top(qsizetype line) const;
+    qint64    total() const {return this->top(m_heights.size());};
+    qsizetype lineAt(qint64 y) const;
+
+private:
+    QList<qint32>         m_heights;
+    mutable QList<qint64> m_tree;
+    mutable bool          m_stale = false;
+
+    void build() const;
+};
+} // namespace Collett
+
+#endif // COLLETT_HEIGHT_INDEX_H
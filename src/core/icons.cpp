@@ -24,13 +24,32 @@
 #include "settings.h"
 #include "theme.h"
 
+#include <cstring>
+
 #include <QByteArray>
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QGuiApplication>
 #include <QIcon>
+#include <QImage>
+#include <QPainter>
 #include <QPixmap>
 #include <QSize>
+#include <QStandardPaths>
 #include <QString>
+#include <QSvgRenderer>
 #include <QTextStream>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#define ICON_PACK_MAGIC "CLTICONS"
+#define ICON_PACK_VERSION 1
+#define ICON_PACK_HEADER 40
+#define ICON_PACK_ENTRY 16
 
 namespace Collett {
 
@@ -43,25 +62,454 @@ Icons::Icons(Theme *parent) : QObject(parent), m_theme(parent) {
 
 Icons::~Icons() {
     qDebug() << "Destructor: Icons";
+    m_prewarm.waitForFinished();
 }
 
 // Getters
 // =======
 
 QIcon Icons::getIcon(QString name, ThemeColor color, QSize size) {
-    QString key = name + QString::number(color) + "-"
-                + QString::number(size.width()) + "x"
-                + QString::number(size.height());
+    QString key = Icons::iconKey(name, color, size);
     if (!m_icons.contains(key)) {
-        m_icons[key] = this->generateIcon(name, color, size);
+        if (m_prewarmKeys.contains(key)) {
+            this->collectPrewarm();
+        }
+        if (m_prewarmed.contains(key)) {
+            m_icons[key] = QIcon(QPixmap::fromImage(m_prewarmed.take(key)));
+        } else {
+            m_icons[key] = this->generateIcon(name, color, size);
+        }
     }
     qDebug() << "Requested Icon:" << key;
     return m_icons[key];
 }
 
+/**!
+ * @brief Get the icon of a project item.
+ *
+ * The icons are also kept in a lookup keyed on the item values, which
+ * avoids building the string key on every call from the project model.
+ */
 QIcon Icons::getProjectIcon(ItemType itemType, ItemClass itemClass, ItemLevel itemLevel, QSize size) {
-    QString name = "none";
-    ThemeColor color = ThemeColor::DefaultColor;
+    quint64 key = (quint64(size.width()) << 48) | (quint64(size.height()) << 32)
+                | (quint64(itemType) << 16) | (quint64(itemClass) << 8) | quint64(itemLevel);
+    auto it = m_projectIcons.constFind(key);
+    if (it != m_projectIcons.constEnd()) {
+        return it.value();
+    }
+
+    QIcon icon;
+    QString name;
+    ThemeColor color;
+    if (Icons::projectIconSpec(itemType, itemClass, itemLevel, name, color)) {
+        icon = this->getIcon(name, color, size);
+    }
+    m_projectIcons.insert(key, icon);
+    return icon;
+}
+
+/**!
+ * @brief Get the icon for the active state of a project item.
+ *
+ * @param checkable True if the item has an active state.
+ * @param active    The active state of the item.
+ * @param size      The size of the icon.
+ */
+QIcon Icons::getStateIcon(bool checkable, bool active, QSize size) {
+    quint64 key = (quint64(size.width()) << 48) | (quint64(size.height()) << 32)
+                | (quint64(0xff) << 16) | (checkable ? 2 : 0) | (active ? 1 : 0);
+    auto it = m_projectIcons.constFind(key);
+    if (it != m_projectIcons.constEnd()) {
+        return it.value();
+    }
+
+    QIcon icon;
+    if (!checkable) {
+        icon = this->getIcon("noncheckable", ThemeColor::FadedColor, size);
+    } else if (active) {
+        icon = this->getIcon("checked", ThemeColor::Green, size);
+    } else {
+        icon = this->getIcon("unchecked", ThemeColor::Red, size);
+    }
+    m_projectIcons.insert(key, icon);
+    return icon;
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Load an icon set from the assets folder.
+ *
+ * The binary icon pack is preferred if it exists, since it can be memory
+ * mapped and indexed directly. If it is missing or invalid, the text version
+ * of the icon set is parsed instead.
+ *
+ * @param icons The name of the icon set.
+ * @return true if the icon set was loaded.
+ */
+bool Icons::loadIcons(QString icons) {
+
+    QDir iconsDir = Settings::assetPath("icons");
+    qInfo() << "Loading Icons:" << icons;
+
+    this->collectPrewarm();
+    m_prewarmed.clear();
+    m_masks.clear();
+    m_svg.clear();
+    m_icons.clear();
+    m_projectIcons.clear();
+    m_setHash.clear();
+    if (m_pack.isOpen()) m_pack.close();
+
+    bool loaded = false;
+    QFileInfo packFile = QFileInfo(iconsDir.filePath(icons + ".iconpack"));
+    if (packFile.exists()) {
+        loaded = this->loadIconPack(packFile.filePath());
+    }
+    QFileInfo iconsFile = QFileInfo(iconsDir.filePath(icons + ".icons"));
+    if (!loaded && iconsFile.exists()) {
+        loaded = this->loadIconText(iconsFile.filePath());
+    }
+    if (!loaded) {
+        return false;
+    }
+
+    // The cache key is the content of the set, so that edited icon files
+    // never pick up stale images from a previous version
+    QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheRoot.isEmpty()) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (auto [key, svg] : m_svg.asKeyValueRange()) {
+            hash.addData(key.toUtf8());
+            hash.addData(svg);
+        }
+        m_setHash = QString::fromLatin1(hash.result().toHex().first(16));
+        m_cacheDir = QDir(cacheRoot + "/icons/" + m_setHash);
+        qDebug() << "Icon Cache:" << m_cacheDir.path();
+    }
+
+    return true;
+}
+
+/**!
+ * @brief Drop all tinted icons after a change of theme colours.
+ *
+ * The untinted masks and the SVG data are kept, so new icons are made by
+ * tinting the masks again when they are requested.
+ */
+void Icons::retint() {
+    this->collectPrewarm();
+    m_prewarmed.clear();
+    m_icons.clear();
+    m_projectIcons.clear();
+}
+
+/**!
+ * @brief Render the project icons in the background.
+ *
+ * All icons that can be returned by getProjectIcon(), as well as the active
+ * state icons, are rendered at the given size on the global thread pool.
+ * The images are collected the first time one of them is requested, and
+ * converted to pixmaps on the GUI thread at that point.
+ *
+ * @param size The icon size to render.
+ */
+void Icons::prewarm(QSize size) {
+
+    this->collectPrewarm();
+
+    qreal dpr = qGuiApp->devicePixelRatio();
+    QList<PrewarmJob> jobs;
+    auto addJob = [&](const QString &name, ThemeColor color) {
+        QString key = Icons::iconKey(name, color, size);
+        if (!m_svg.contains(name) || m_icons.contains(key) || m_prewarmKeys.contains(key)) return;
+        QColor tint = m_theme->m_colors.at(color);
+        QByteArray svg = m_svg.value(name);
+        jobs.append({
+            key, name, QByteArray(svg.constData(), svg.size()), tint, size, dpr,
+            this->cacheFile(name, tint, size, dpr)
+        });
+        m_prewarmKeys.insert(key);
+    };
+
+    QString name;
+    ThemeColor color;
+    for (int c = ItemClass::NovelClass; c <= ItemClass::TrashClass; ++c) {
+        if (Icons::projectIconSpec(ItemType::RootType, ItemClass(c), ItemLevel::PageLevel, name, color)) {
+            addJob(name, color);
+        }
+    }
+    if (Icons::projectIconSpec(ItemType::FolderType, ItemClass::NovelClass, ItemLevel::PageLevel, name, color)) {
+        addJob(name, color);
+    }
+    for (int l = ItemLevel::PageLevel; l <= ItemLevel::NoteLevel; ++l) {
+        if (Icons::projectIconSpec(ItemType::FileType, ItemClass::NovelClass, ItemLevel(l), name, color)) {
+            addJob(name, color);
+        }
+    }
+    addJob("checked", ThemeColor::Green);
+    addJob("unchecked", ThemeColor::Red);
+    addJob("noncheckable", ThemeColor::FadedColor);
+
+    if (!jobs.isEmpty()) {
+        if (!m_setHash.isEmpty()) m_cacheDir.mkpath(".");
+        qDebug() << "Prewarming Icons:" << jobs.size();
+        m_prewarm = QtConcurrent::mapped(std::move(jobs), &Icons::prewarmIcon);
+    }
+}
+
+// Private Methods
+// ===============
+
+/**!
+ * @brief Load a binary icon pack generated by utils/icons.py.
+ *
+ * The file is memory mapped and kept open for the lifetime of the icon set.
+ * The SVG data is referenced directly from the mapped memory, so no copies
+ * are made until an icon is generated.
+ *
+ * @param path The path to the .iconpack file.
+ * @return true if the pack was valid and loaded.
+ */
+bool Icons::loadIconPack(const QString &path) {
+
+    m_pack.setFileName(path);
+    if (!m_pack.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open file:" << path;
+        return false;
+    }
+
+    qint64 size = m_pack.size();
+    const uchar *data = size >= ICON_PACK_HEADER ? m_pack.map(0, size) : nullptr;
+    if (!data || memcmp(data, ICON_PACK_MAGIC, 8) != 0) {
+        qWarning() << "Invalid icon pack:" << path;
+        m_pack.close();
+        return false;
+    }
+
+    quint32 version = qFromLittleEndian<quint32>(data + 8);
+    quint32 count = qFromLittleEndian<quint32>(data + 12);
+    if (version != ICON_PACK_VERSION || ICON_PACK_HEADER + qint64(count)*ICON_PACK_ENTRY > size) {
+        qWarning() << "Unsupported icon pack:" << path;
+        m_pack.close();
+        return false;
+    }
+
+    auto span = [data, size](qint64 pos, QByteArray &value) -> bool {
+        quint32 offset = qFromLittleEndian<quint32>(data + pos);
+        quint32 length = qFromLittleEndian<quint32>(data + pos + 4);
+        if (qint64(offset) + qint64(length) > size) return false;
+        value = QByteArray::fromRawData(reinterpret_cast<const char*>(data + offset), length);
+        return true;
+    };
+
+    QByteArray name, author, license;
+    if (!span(16, name) || !span(24, author) || !span(32, license)) {
+        qWarning() << "Corrupt icon pack:" << path;
+        m_pack.close();
+        return false;
+    }
+    m_name = QString::fromUtf8(name);
+    m_author = QString::fromUtf8(author);
+    m_license = QString::fromUtf8(license);
+    qDebug() << "IconSet Name:" << m_name;
+    qDebug() << "IconSet Author:" << m_author;
+    qDebug() << "IconSet License:" << m_license;
+
+    for (quint32 i = 0; i < count; ++i) {
+        qint64 entry = ICON_PACK_HEADER + qint64(i)*ICON_PACK_ENTRY;
+        QByteArray key, svg;
+        if (!span(entry, key) || !span(entry + 8, svg)) {
+            qWarning() << "Corrupt icon pack:" << path;
+            m_svg.clear();
+            m_pack.close();
+            return false;
+        }
+        if (svg.startsWith("<svg")) m_svg[QString::fromUtf8(key)] = svg;
+    }
+
+    return true;
+}
+
+/**!
+ * @brief Load a text icon set file.
+ *
+ * @param path The path to the .icons file.
+ * @return true if the file could be read.
+ */
+bool Icons::loadIconText(const QString &path) {
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Could not open file:" << path;
+        return false;
+    }
+
+    QTextStream input(&file);
+    while (!input.atEnd()) {
+        QString line = input.readLine();
+        qsizetype eqPos = line.indexOf("=");
+        if (eqPos > 5) {
+            if (line.startsWith("icon:")) {
+                QString key(line.first(eqPos).sliced(5).trimmed());
+                QByteArray svg(line.sliced(eqPos + 1).trimmed().toLatin1());
+                if (svg.startsWith("<svg")) m_svg[key] = svg;
+            } else if (line.startsWith("meta:name")) {
+                m_name = line.sliced(eqPos + 1).trimmed();
+                qDebug() << "IconSet Name:" << m_name;
+            } else if (line.startsWith("meta:author")) {
+                m_author = line.sliced(eqPos + 1).trimmed();
+                qDebug() << "IconSet Author:" << m_author;
+            } else if (line.startsWith("meta:license")) {
+                m_license = line.sliced(eqPos + 1).trimmed();
+                qDebug() << "IconSet License:" << m_license;
+            }
+        }
+    }
+    file.close();
+
+    return true;
+}
+
+/**!
+ * @brief Generate a tinted icon.
+ *
+ * The rendered pixmap is looked up in the on-disk cache first. If it is not
+ * there, the icon mask is tinted with the colour, and the mask itself is
+ * only rendered from the SVG data the first time it is needed. Newly tinted
+ * images are written back to the cache.
+ *
+ * @param name  The name of the icon.
+ * @param color The theme colour to tint the icon with.
+ * @param size  The logical size of the icon.
+ * @return QIcon The icon, or an empty icon if it does not exist.
+ */
+QIcon Icons::generateIcon(QString name, ThemeColor color, QSize size) {
+    if (!m_svg.contains(name)) {
+        return QIcon();
+    }
+
+    QColor tint = m_theme->m_colors.at(color);
+    qreal dpr = qGuiApp->devicePixelRatio();
+    QString cached = this->cacheFile(name, tint, size, dpr);
+
+    QImage image;
+    if (!cached.isEmpty() && image.load(cached, "PNG")) {
+        qDebug() << "Cached Icon:" << name;
+    } else {
+        QString maskKey = Icons::maskKey(name, size, dpr);
+        if (!m_masks.contains(maskKey)) {
+            m_masks.insert(maskKey, Icons::renderMask(m_svg[name], size, dpr));
+        }
+        image = Icons::tintMask(m_masks.value(maskKey), tint);
+        if (!cached.isEmpty() && !image.isNull()) {
+            m_cacheDir.mkpath(".");
+            image.save(cached, "PNG");
+        }
+    }
+    image.setDevicePixelRatio(dpr);
+
+    return QIcon(QPixmap::fromImage(image));
+}
+
+/**!
+ * @brief Build the on-disk cache file path for an icon.
+ *
+ * The cache is grouped by the hash of the icon set, so a changed icon set
+ * never picks up stale images. The rest of the key is in the file name.
+ *
+ * @return QString The file path, or an empty string if there is no cache.
+ */
+QString Icons::cacheFile(const QString &name, const QColor &color, QSize size, qreal dpr) const {
+    if (m_setHash.isEmpty()) {
+        return QString();
+    }
+    return m_cacheDir.filePath(QString("%1-%2-%3x%4@%5.png").arg(
+        name, color.name(QColor::HexArgb).sliced(1),
+        QString::number(size.width()), QString::number(size.height()),
+        QString::number(qRound(100.0*dpr))
+    ));
+}
+
+/**!
+ * @brief Render an SVG icon into an untinted mask image.
+ *
+ * The icon set uses black for all shapes, so the alpha channel of the mask
+ * holds the whole icon. This function does not touch any shared state and is
+ * safe to call from any thread.
+ */
+QImage Icons::renderMask(const QByteArray &svg, QSize size, qreal dpr) {
+    QSvgRenderer renderer(svg);
+    if (!renderer.isValid()) {
+        return QImage();
+    }
+
+    QImage image(size*dpr, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    renderer.render(&painter);
+    painter.end();
+
+    return image;
+}
+
+/**!
+ * @brief Fill the shapes of a mask image with a colour.
+ */
+QImage Icons::tintMask(const QImage &mask, const QColor &color) {
+    if (mask.isNull()) {
+        return QImage();
+    }
+
+    QImage image(mask);
+    QPainter painter(&image);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    painter.fillRect(image.rect(), color);
+    painter.end();
+
+    return image;
+}
+
+/**!
+ * @brief Wait for the prewarm jobs and move the results into storage.
+ */
+void Icons::collectPrewarm() {
+    if (!m_prewarmKeys.isEmpty()) {
+        m_prewarm.waitForFinished();
+        for (const PrewarmResult &result : m_prewarm.results()) {
+            if (!result.image.isNull()) m_prewarmed.insert(result.key, result.image);
+            if (!result.mask.isNull()) m_masks.insert(result.maskKey, result.mask);
+        }
+        m_prewarm = QFuture<PrewarmResult>();
+    }
+    m_prewarmKeys.clear();
+}
+
+// Static Methods
+// ==============
+
+QString Icons::iconKey(const QString &name, ThemeColor color, QSize size) {
+    return name + QString::number(color) + "-"
+         + QString::number(size.width()) + "x"
+         + QString::number(size.height());
+}
+
+QString Icons::maskKey(const QString &name, QSize size, qreal dpr) {
+    return name + "-"
+         + QString::number(size.width()) + "x"
+         + QString::number(size.height()) + "@"
+         + QString::number(qRound(100.0*dpr));
+}
+
+/**!
+ * @brief Look up the icon name and colour of a project item.
+ *
+ * @return true if the item has an icon.
+ */
+bool Icons::projectIconSpec(ItemType itemType, ItemClass itemClass, ItemLevel itemLevel, QString &name, ThemeColor &color) {
+    name = "none";
+    color = ThemeColor::DefaultColor;
     switch (itemType) {
         case ItemType::RootType:
             switch (itemClass) {
@@ -125,67 +573,27 @@ QIcon Icons::getProjectIcon(ItemType itemType, ItemClass itemClass, ItemLevel it
         default:
             break;
     }
-    if (name != "none") {
-        return this->getIcon(name, color, size);
-    } else {
-        return QIcon();
-    }
+    return name != "none";
 }
 
-// Public Methods
-// ==============
-
-bool Icons::loadIcons(QString icons) {
-
-    QFileInfo iconsFile = QFileInfo(Settings::assetPath("icons").filePath(icons + ".icons"));
-    if (!iconsFile.exists()) return false;
-    qInfo() << "Loading Icons:" << icons;
-
-    QFile file(iconsFile.filePath());
-    if (!file.open(QIODevice::ReadOnly)) {
-        qCritical() << "Could not open file:" << iconsFile.filePath();
-        return false;
-    }
-
-    QTextStream input(&file);
-    while (!input.atEnd()) {
-        QString line = input.readLine();
-        qsizetype eqPos = line.indexOf("=");
-        if (eqPos > 5) {
-            if (line.startsWith("icon:")) {
-                QString key(line.first(eqPos).sliced(5).trimmed());
-                QByteArray svg(line.sliced(eqPos + 1).trimmed().toLatin1());
-                if (svg.startsWith("<svg")) m_svg[key] = svg;
-            } else if (line.startsWith("meta:name")) {
-                m_name = line.sliced(eqPos + 1).trimmed();
-                qDebug() << "IconSet Name:" << m_name;
-            } else if (line.startsWith("meta:author")) {
-                m_author = line.sliced(eqPos + 1).trimmed();
-                qDebug() << "IconSet Author:" << m_author;
-            } else if (line.startsWith("meta:license")) {
-                m_license = line.sliced(eqPos + 1).trimmed();
-                qDebug() << "IconSet License:" << m_license;
-            }
+/**!
+ * @brief Prewarm worker for a single icon.
+ *
+ * Runs on the thread pool, so it only uses the data in the job.
+ */
+Icons::PrewarmResult Icons::prewarmIcon(const PrewarmJob &job) {
+    PrewarmResult result;
+    result.key = job.key;
+    result.maskKey = Icons::maskKey(job.name, job.size, job.dpr);
+    if (job.cacheFile.isEmpty() || !result.image.load(job.cacheFile, "PNG")) {
+        result.mask = Icons::renderMask(job.svg, job.size, job.dpr);
+        result.image = Icons::tintMask(result.mask, job.color);
+        if (!job.cacheFile.isEmpty() && !result.image.isNull()) {
+            result.image.save(job.cacheFile, "PNG");
         }
     }
-    file.close();
-
-    return true;
-}
-
-// Private Methods
-// ===============
-
-QIcon Icons::generateIcon(QString name, ThemeColor color, QSize size) {
-    if (m_svg.contains(name)) {
-        QByteArray svg(m_svg[name]);
-        svg.replace("#000000", QByteArray::fromStdString(m_theme->m_colors.at(color).name(QColor::HexRgb).toStdString()));
-        QPixmap pixmap(size);
-        pixmap.fill(Qt::transparent);
-        pixmap.loadFromData(svg, "svg");
-        return QIcon(pixmap);
-    }
-    return QIcon();
+    result.image.setDevicePixelRatio(job.dpr);
+    return result;
 }
 
 } // namespace Collett
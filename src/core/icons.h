@@ -26,8 +26,15 @@
 #include "settings.h"
 
 #include <QByteArray>
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
 #include <QIcon>
+#include <QImage>
 #include <QMap>
+#include <QSet>
 #include <QSize>
 #include <QString>
 
@@ -46,11 +53,30 @@ public:
     QIcon getIcon(QString name, ThemeColor color, QSize size);
     QIcon getIcon(QString name, ThemeColor color) {return getIcon(name, color, QSize(24, 24));};
     QIcon getProjectIcon(ItemType itemType, ItemClass itemClass, ItemLevel itemLevel, QSize size);
+    QIcon getStateIcon(bool checkable, bool active, QSize size);
 
     // Methods
     bool loadIcons(QString icons);
+    void retint();
+    void prewarm(QSize size);
 
 private:
+    struct PrewarmJob {
+        QString    key;
+        QString    name;
+        QByteArray svg;
+        QColor     color;
+        QSize      size;
+        qreal      dpr;
+        QString    cacheFile;
+    };
+    struct PrewarmResult {
+        QString key;
+        QString maskKey;
+        QImage  image;
+        QImage  mask;
+    };
+
     Theme    *m_theme;
     Settings *m_settings;
 
@@ -59,12 +85,36 @@ private:
     QString m_author = "";
     QString m_license = "";
 
+    // Cache
+    QString m_setHash = "";
+    QDir    m_cacheDir;
+
     // Storage
+    QFile                     m_pack;
     QMap<QString, QByteArray> m_svg;
     QMap<QString, QIcon>      m_icons;
+    QHash<QString, QImage>    m_masks;
+    QHash<quint64, QIcon>     m_projectIcons;
+
+    // Prewarm
+    QFuture<PrewarmResult> m_prewarm;
+    QSet<QString>          m_prewarmKeys;
+    QHash<QString, QImage> m_prewarmed;
 
     // Functions
-    QIcon generateIcon(QString name, ThemeColor color, QSize size);
+    bool  loadIconPack(const QString &path);
+    bool  loadIconText(const QString &path);
+    QIcon   generateIcon(QString name, ThemeColor color, QSize size);
+    QString cacheFile(const QString &name, const QColor &color, QSize size, qreal dpr) const;
+    void    collectPrewarm();
+
+    // Static Functions
+    static QString iconKey(const QString &name, ThemeColor color, QSize size);
+    static bool projectIconSpec(ItemType itemType, ItemClass itemClass, ItemLevel itemLevel, QString &name, ThemeColor &color);
+    static QString maskKey(const QString &name, QSize size, qreal dpr);
+    static QImage renderMask(const QByteArray &svg, QSize size, qreal dpr);
+    static QImage tintMask(const QImage &mask, const QColor &color);
+    static PrewarmResult prewarmIcon(const PrewarmJob &job);
 };
 } // namespace Collett
 
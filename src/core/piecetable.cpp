@@ -0,0 +1,429 @@
+/*
+** Collett – Piece Table Class
+** ===========================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "piecetable.h"
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+namespace Collett {
+
+// Constructor
+// ===========
+
+PieceTable::PieceTable(const QString &text) {
+    this->setText(text);
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Replace the content with new text.
+ *
+ * The text is kept as the original buffer and split into pieces of at most
+ * PIECE_CHUNK_SIZE characters, so that splitting a piece later only needs to
+ * scan a bounded number of characters.
+ *
+ * @param text The new text.
+ */
+void PieceTable::setText(const QString &text) {
+    this->clear();
+    m_original = text;
+    m_root = this->buildPieces(OriginalBuffer, 0, m_original.size());
+}
+
+void PieceTable::clear() {
+    m_original.clear();
+    m_added.clear();
+    m_pieces.clear();
+    m_free.clear();
+    m_root = -1;
+}
+
+/**!
+ * @brief Insert text at a position.
+ *
+ * The text is appended to the added buffer. Text typed at the end of the
+ * last insert extends that piece instead of adding a new one.
+ *
+ * @param pos  The position to insert at. It is clamped to the text.
+ * @param text The text to insert.
+ */
+void PieceTable::insert(qsizetype pos, const QString &text) {
+    if (text.isEmpty()) return;
+
+    pos = qBound<qsizetype>(0, pos, this->length());
+    qsizetype start = m_added.size();
+    m_added.append(text);
+
+    qint32 l, r;
+    this->split(m_root, pos, l, r);
+    if (text.size() > PIECE_CHUNK_SIZE || !this->extendLast(l, text.size(), countNewlines(text.constData(), text.size()))) {
+        l = this->merge(l, this->buildPieces(AddedBuffer, start, text.size()));
+    }
+    m_root = this->merge(l, r);
+}
+
+/**!
+ * @brief Remove a range of text.
+ *
+ * @param pos    The start of the range.
+ * @param length The number of characters to remove.
+ */
+void PieceTable::remove(qsizetype pos, qsizetype length) {
+    pos = qBound<qsizetype>(0, pos, this->length());
+    length = qBound<qsizetype>(0, length, this->length() - pos);
+    if (length == 0) return;
+
+    qint32 l, m, r;
+    this->split(m_root, pos, l, r);
+    this->split(r, length, m, r);
+    this->releasePieces(m);
+    m_root = this->merge(l, r);
+}
+
+// Getters
+// =======
+
+qsizetype PieceTable::length() const {
+    return this->subLength(m_root);
+}
+
+qsizetype PieceTable::lineCount() const {
+    return this->subNewlines(m_root) + 1;
+}
+
+/**!
+ * @brief Get the position of the first character of a line.
+ *
+ * @param line      The line number, starting at 0.
+ * @return qsizetype The position, or the text length if out of range.
+ */
+qsizetype PieceTable::lineStart(qsizetype line) const {
+    if (line <= 0) return 0;
+    if (line >= this->lineCount()) return this->length();
+
+    qsizetype pos = 0;
+    qint32 t = m_root;
+    while (t >= 0) {
+        const Piece &piece = m_pieces.at(t);
+        qsizetype leftLines = this->subNewlines(piece.left);
+        if (line <= leftLines) {
+            t = piece.left;
+        } else if (line <= leftLines + piece.newlines) {
+            qsizetype offset = findNewline(this->pieceData(piece), piece.length, line - leftLines);
+            return pos + this->subLength(piece.left) + offset + 1;
+        } else {
+            line -= leftLines + piece.newlines;
+            pos += this->subLength(piece.left) + piece.length;
+            t = piece.right;
+        }
+    }
+    return this->length();
+}
+
+/**!
+ * @brief Get the position of the newline ending a line.
+ *
+ * @param line      The line number, starting at 0.
+ * @return qsizetype The position, or the text length for the last line.
+ */
+qsizetype PieceTable::lineEnd(qsizetype line) const {
+    if (line + 1 >= this->lineCount()) return this->length();
+    return this->lineStart(line + 1) - 1;
+}
+
+/**!
+ * @brief Get the line number of a position.
+ *
+ * @param pos       The position in the text.
+ * @return qsizetype The line number, starting at 0.
+ */
+qsizetype PieceTable::lineAt(qsizetype pos) const {
+    qsizetype line = 0;
+    qint32 t = m_root;
+    while (t >= 0) {
+        const Piece &piece = m_pieces.at(t);
+        qsizetype leftLength = this->subLength(piece.left);
+        if (pos < leftLength) {
+            t = piece.left;
+        } else if (pos < leftLength + piece.length) {
+            return line + this->subNewlines(piece.left) + countNewlines(this->pieceData(piece), pos - leftLength);
+        } else {
+            line += this->subNewlines(piece.left) + piece.newlines;
+            pos -= leftLength + piece.length;
+            t = piece.right;
+        }
+    }
+    return line;
+}
+
+/**!
+ * @brief Get the approximate memory held by the buffers and pieces.
+ */
+qsizetype PieceTable::memoryUsage() const {
+    return (m_original.capacity() + m_added.capacity()) * sizeof(QChar) + m_pieces.capacity() * sizeof(Piece);
+}
+
+QString PieceTable::text() const {
+    return this->text(0, this->length());
+}
+
+/**!
+ * @brief Get a range of text.
+ *
+ * Only the pieces overlapping the range are visited.
+ *
+ * @param pos    The start of the range.
+ * @param length The number of characters.
+ * @return QString The text of the range.
+ */
+QString PieceTable::text(qsizetype pos, qsizetype length) const {
+    pos = qBound<qsizetype>(0, pos, this->length());
+    length = qBound<qsizetype>(0, length, this->length() - pos);
+    QString out;
+    out.reserve(length);
+    this->collect(m_root, pos, pos + length, 0, out);
+    return out;
+}
+
+/**!
+ * @brief Get a range of lines, without the final newline.
+ *
+ * @param first The first line.
+ * @param count The number of lines.
+ * @return QString The text of the lines.
+ */
+QString PieceTable::lines(qsizetype first, qsizetype count) const {
+    if (count <= 0) return QString();
+    qsizetype start = this->lineStart(first);
+    return this->text(start, this->lineEnd(first + count - 1) - start);
+}
+
+/**!
+ * @brief Get the text as a list of views into the buffers.
+ *
+ * This lets the text be written out without building it as one string. The
+ * views are only valid until the table is next changed.
+ *
+ * @return QList<QStringView> The views, in text order.
+ */
+QList<QStringView> PieceTable::chunks() const {
+    QList<QStringView> out;
+    out.reserve(this->pieceCount());
+    QList<qint32> stack;
+    qint32 t = m_root;
+    while (t >= 0 || !stack.isEmpty()) {
+        while (t >= 0) {
+            stack.append(t);
+            t = m_pieces.at(t).left;
+        }
+        t = stack.takeLast();
+        const Piece &piece = m_pieces.at(t);
+        out.append(QStringView(this->pieceData(piece), piece.length));
+        t = piece.right;
+    }
+    return out;
+}
+
+// Tree Methods
+// ============
+
+qint32 PieceTable::newPiece(Buffer buffer, qsizetype start, qsizetype length, qsizetype newlines) {
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    Piece piece = {-1, -1, m_seed, buffer, start, length, newlines, length, newlines};
+    if (newlines < 0) {
+        piece.newlines = countNewlines(this->pieceData(piece), length);
+        piece.subNewlines = piece.newlines;
+    }
+
+    if (m_free.isEmpty()) {
+        m_pieces.append(piece);
+        return static_cast<qint32>(m_pieces.size() - 1);
+    } else {
+        qint32 t = m_free.takeLast();
+        m_pieces[t] = piece;
+        return t;
+    }
+}
+
+void PieceTable::releasePieces(qint32 t) {
+    QList<qint32> stack;
+    if (t >= 0) stack.append(t);
+    while (!stack.isEmpty()) {
+        qint32 c = stack.takeLast();
+        const Piece &piece = m_pieces.at(c);
+        if (piece.left >= 0) stack.append(piece.left);
+        if (piece.right >= 0) stack.append(piece.right);
+        m_free.append(c);
+    }
+}
+
+void PieceTable::update(qint32 t) {
+    Piece &piece = m_pieces[t];
+    piece.subLength = this->subLength(piece.left) + piece.length + this->subLength(piece.right);
+    piece.subNewlines = this->subNewlines(piece.left) + piece.newlines + this->subNewlines(piece.right);
+}
+
+/**!
+ * @brief Split a sub tree so that the left part holds pos characters.
+ *
+ * A piece straddling the split point is cut in two, and only the head of
+ * the piece is scanned for newlines.
+ */
+void PieceTable::split(qint32 t, qsizetype pos, qint32 &l, qint32 &r) {
+    if (t < 0) {
+        l = -1;
+        r = -1;
+        return;
+    }
+
+    qsizetype leftLength = this->subLength(m_pieces.at(t).left);
+    qsizetype pieceLength = m_pieces.at(t).length;
+    if (pos <= leftLength) {
+        qint32 left = m_pieces.at(t).left;
+        this->split(left, pos, l, left);
+        m_pieces[t].left = left;
+        this->update(t);
+        r = t;
+    } else if (pos >= leftLength + pieceLength) {
+        qint32 right = m_pieces.at(t).right;
+        this->split(right, pos - leftLength - pieceLength, right, r);
+        m_pieces[t].right = right;
+        this->update(t);
+        l = t;
+    } else {
+        qsizetype offset = pos - leftLength;
+        const Piece head = m_pieces.at(t);
+        qsizetype headLines = countNewlines(this->pieceData(head), offset);
+
+        // The tail piece is new, so the index must not be held across it
+        qint32 tail = this->newPiece(head.buffer, head.start + offset, head.length - offset, head.newlines - headLines);
+        m_pieces[t].length = offset;
+        m_pieces[t].newlines = headLines;
+        m_pieces[t].right = -1;
+        this->update(t);
+        l = t;
+        r = this->merge(tail, head.right);
+    }
+}
+
+qint32 PieceTable::merge(qint32 l, qint32 r) {
+    if (l < 0) return r;
+    if (r < 0) return l;
+    if (m_pieces.at(l).priority > m_pieces.at(r).priority) {
+        qint32 right = this->merge(m_pieces.at(l).right, r);
+        m_pieces[l].right = right;
+        this->update(l);
+        return l;
+    } else {
+        qint32 left = this->merge(l, m_pieces.at(r).left);
+        m_pieces[r].left = left;
+        this->update(r);
+        return r;
+    }
+}
+
+qint32 PieceTable::buildPieces(Buffer buffer, qsizetype start, qsizetype length) {
+    qint32 t = -1;
+    for (qsizetype offset = 0; offset < length; offset += PIECE_CHUNK_SIZE) {
+        t = this->merge(t, this->newPiece(buffer, start + offset, qMin<qsizetype>(length - offset, PIECE_CHUNK_SIZE)));
+    }
+    return t;
+}
+
+/**!
+ * @brief Extend the last piece of a sub tree with newly added text.
+ *
+ * This only succeeds if the last piece ends where the added text starts,
+ * and the extended piece stays within the chunk size.
+ */
+bool PieceTable::extendLast(qint32 t, qsizetype length, qsizetype newlines) {
+    if (t < 0) return false;
+
+    qint32 right = m_pieces.at(t).right;
+    if (right >= 0) {
+        if (!this->extendLast(right, length, newlines)) return false;
+    } else {
+        Piece &piece = m_pieces[t];
+        if (piece.buffer != AddedBuffer) return false;
+        if (piece.start + piece.length + length != m_added.size()) return false;
+        if (piece.length + length > PIECE_CHUNK_SIZE) return false;
+        piece.length += length;
+        piece.newlines += newlines;
+    }
+    this->update(t);
+    return true;
+}
+
+void PieceTable::collect(qint32 t, qsizetype pos, qsizetype end, qsizetype offset, QString &out) const {
+    if (t < 0 || pos >= end) return;
+
+    const Piece &piece = m_pieces.at(t);
+    qsizetype begin = offset + this->subLength(piece.left);
+    if (pos < begin) {
+        this->collect(piece.left, pos, end, offset, out);
+    }
+    qsizetype first = qMax(pos, begin);
+    qsizetype last = qMin(end, begin + piece.length);
+    if (first < last) {
+        out.append(this->pieceData(piece) + (first - begin), last - first);
+    }
+    if (end > begin + piece.length) {
+        this->collect(piece.right, pos, end, begin + piece.length, out);
+    }
+}
+
+// Helpers
+// =======
+
+const QChar *PieceTable::pieceData(const Piece &piece) const {
+    if (piece.buffer == OriginalBuffer) {
+        return m_original.constData() + piece.start;
+    } else {
+        return m_added.constData() + piece.start;
+    }
+}
+
+// Static Functions
+// ================
+
+qsizetype PieceTable::countNewlines(const QChar *data, qsizetype length) {
+    qsizetype count = 0;
+    for (qsizetype i = 0; i < length; ++i) {
+        count += data[i] == u'\n';
+    }
+    return count;
+}
+
+qsizetype PieceTable::findNewline(const QChar *data, qsizetype length, qsizetype nth) {
+    for (qsizetype i = 0; i < length; ++i) {
+        if (data[i] == u'\n' && --nth == 0) return i;
+    }
+    return length;
+}
+
+} // namespace Collett
@@ -0,0 +1,111 @@
+/*
+** Collett – Piece Table Class
+** ===========================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_PIECE_TABLE_H
+#define COLLETT_PIECE_TABLE_H
+
+#include "collett.h"
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+#define PIECE_CHUNK_SIZE 4096
+
+namespace Collett {
+
+class PieceTable
+{
+public:
+    PieceTable() {};
+    explicit PieceTable(const QString &text);
+    ~PieceTable() {};
+
+    // Methods
+    void setText(const QString &text);
+    void clear();
+    void insert(qsizetype pos, const QString &text);
+    void remove(qsizetype pos, qsizetype length);
+
+    // Getters
+    qsizetype length() const;
+    qsizetype lineCount() const;
+    qsizetype lineStart(qsizetype line) const;
+    qsizetype lineEnd(qsizetype line) const;
+    qsizetype lineAt(qsizetype pos) const;
+    qsizetype pieceCount() const {return m_pieces.size() - m_free.size();};
+    qsizetype memoryUsage() const;
+    QString   text() const;
+    QString   text(qsizetype pos, qsizetype length) const;
+    QString   lines(qsizetype first, qsizetype count) const;
+    QList<QStringView> chunks() const;
+
+private:
+    enum Buffer : quint8 {
+        OriginalBuffer,
+        AddedBuffer,
+    };
+
+    // The pieces are the nodes of an implicit treap, ordered by their
+    // position in the text. Each node also holds the length and newline
+    // count of its sub tree, so that positions and lines can be found by
+    // walking down from the root.
+    struct Piece {
+        qint32    left;
+        qint32    right;
+        quint32   priority;
+        Buffer    buffer;
+        qsizetype start;
+        qsizetype length;
+        qsizetype newlines;
+        qsizetype subLength;
+        qsizetype subNewlines;
+    };
+
+    QString       m_original;
+    QString       m_added;
+    QList<Piece>  m_pieces;
+    QList<qint32> m_free;
+    qint32        m_root = -1;
+    quint32       m_seed = 0x9e3779b9;
+
+    // Tree Methods
+    qint32 newPiece(Buffer buffer, qsizetype start, qsizetype length, qsizetype newlines=-1);
+    void   releasePieces(qint32 t);
+    void   update(qint32 t);
+    void   split(qint32 t, qsizetype pos, qint32 &l, qint32 &r);
+    qint32 merge(qint32 l, qint32 r);
+    qint32 buildPieces(Buffer buffer, qsizetype start, qsizetype length);
+    bool   extendLast(qint32 t, qsizetype length, qsizetype newlines);
+    void   collect(qint32 t, qsizetype pos, qsizetype end, qsizetype offset, QString &out) const;
+
+    // Helpers
+    const QChar *pieceData(const Piece &piece) const;
+    qsizetype subLength(qint32 t) const {return t < 0 ? 0 : m_pieces.at(t).subLength;};
+    qsizetype subNewlines(qint32 t) const {return t < 0 ? 0 : m_pieces.at(t).subNewlines;};
+
+    // Static Functions
+    static qsizetype countNewlines(const QChar *data, qsizetype length);
+    static qsizetype findNewline(const QChar *data, qsizetype length, qsizetype nth);
+};
+} // namespace Collett
+
+#endif // COLLETT_PIECE_TABLE_H
@@ -29,6 +29,16 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonParseError>
+#include <QUuid>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#elif defined(Q_OS_MACOS)
+#include <sys/clonefile.h>
+#endif
 
 namespace Collett {
 
@@ -64,7 +74,7 @@ Storage::~Storage() {
 
 bool Storage::readProject(QJsonObject &fileData) {
     if (m_isValid) {
-        return this->readJson(m_projectDir.filePath("project.json"), fileData, true);
+        return this->readJson(this->projectFile(), fileData, true);
     }
     return false;
 }
@@ -72,14 +82,14 @@ bool Storage::readProject(QJsonObject &fileData) {
 bool Storage::writeProject(const QJsonObject &fileData) {
     if (m_isValid) {
         writeCollett();
-        return this->writeJson(m_projectDir.filePath("project.json"), fileData);
+        return this->writeJson(this->projectFile(), fileData);
     }
     return false;
 }
 
 bool Storage::readStructure(QJsonObject &fileData) {
     if (m_isValid) {
-        return this->readJson(m_projectDir.filePath("structure.json"), fileData, false);
+        return this->readJson(this->structureFile(), fileData, false);
     }
     return false;
 }
@@ -87,11 +97,66 @@ bool Storage::readStructure(QJsonObject &fileData) {
 bool Storage::writeStructure(const QJsonObject &fileData) {
     if (m_isValid) {
         writeCollett();
-        return this->writeJson(m_projectDir.filePath("structure.json"), fileData);
+        return this->writeJson(this->structureFile(), fileData);
     }
     return false;
 }
 
+bool Storage::writeContentIndex(const QJsonObject &fileData) {
+    if (m_isValid) {
+        return this->writeJson(this->contentIndexFile(), fileData);
+    }
+    return false;
+}
+
+// Content Files
+// =============
+
+/**!
+ * @brief Return the path of the content file of a project item.
+ */
+QString Storage::contentPath(const QUuid &handle) const {
+    return m_contentDir.filePath(Storage::contentFileName(handle));
+}
+
+/**!
+ * @brief Return the path of the autosave journal of a project item.
+ */
+QString Storage::journalPath(const QUuid &handle) const {
+    return m_contentDir.filePath(handle.toString(QUuid::WithoutBraces) + ".log");
+}
+
+/**!
+ * @brief Copy the content file of one project item to another.
+ *
+ * It is not an error if the source item has no content file.
+ *
+ * @param source The handle of the item to copy from.
+ * @param target The handle of the item to copy to.
+ * @return bool  True if the content was copied or there was none.
+ */
+bool Storage::copyContent(const QUuid &source, const QUuid &target) {
+    if (!m_isValid) return false;
+
+    QString sourcePath = this->contentPath(source);
+    if (!QFileInfo::exists(sourcePath)) {
+        return true;
+    }
+    if (!Storage::cloneFile(sourcePath, this->contentPath(target))) {
+        m_lastError = tr("Could not copy file: %1").arg(sourcePath);
+        return false;
+    }
+    return true;
+}
+
+bool Storage::removeContent(const QUuid &handle) {
+    if (!m_isValid) return false;
+    QString path = this->contentPath(handle);
+    QString journal = this->journalPath(handle);
+    if (QFileInfo::exists(journal)) QFile::remove(journal);
+    return !QFileInfo::exists(path) || QFile::remove(path);
+}
+
 // Getters
 // =======
 
@@ -103,6 +168,52 @@ QString Storage::projectPath() const {
     }
 }
 
+// Static Methods
+// ==============
+
+QString Storage::contentFileName(const QUuid &handle) {
+    return handle.toString(QUuid::WithoutBraces) + ".txt";
+}
+
+/**!
+ * @brief Copy a file, sharing its data blocks where possible.
+ *
+ * On file systems with copy-on-write support, like Btrfs, XFS and APFS, the
+ * copy is made as a reflink/clone, which is instant and uses no extra space
+ * until one of the files is changed. Otherwise, the file is copied.
+ *
+ * @param source The file to copy.
+ * @param target The new file. An existing file is replaced.
+ * @return bool  True if the file was copied.
+ */
+bool Storage::cloneFile(const QString &source, const QString &target) {
+
+    if (QFileInfo::exists(target) && !QFile::remove(target)) {
+        return false;
+    }
+
+#if defined(Q_OS_LINUX)
+    int sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (sourceFd >= 0) {
+        bool cloned = false;
+        int targetFd = ::open(QFile::encodeName(target).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (targetFd >= 0) {
+            cloned = ::ioctl(targetFd, FICLONE, sourceFd) == 0;
+            ::close(targetFd);
+            if (!cloned) QFile::remove(target);
+        }
+        ::close(sourceFd);
+        if (cloned) return true;
+    }
+#elif defined(Q_OS_MACOS)
+    if (::clonefile(QFile::encodeName(source).constData(), QFile::encodeName(target).constData(), 0) == 0) {
+        return true;
+    }
+#endif
+
+    return QFile::copy(source, target);
+}
+
 // Private Methods
 // ===============
 
@@ -27,6 +27,7 @@
 #include <QDir>
 #include <QJsonObject>
 #include <QString>
+#include <QUuid>
 
 namespace Collett {
 
@@ -43,15 +44,30 @@ public:
     bool writeProject(const QJsonObject &fileData);
     bool readStructure(QJsonObject &fileData);
     bool writeStructure(const QJsonObject &fileData);
+    bool writeContentIndex(const QJsonObject &fileData);
+
+    // Content Files
+    QString contentPath(const QUuid &handle) const;
+    QString journalPath(const QUuid &handle) const;
+    bool copyContent(const QUuid &source, const QUuid &target);
+    bool removeContent(const QUuid &handle);
 
     // Getters
     bool isValid() const {return m_isValid;};
     QString projectPath() const;
+    QString projectFile() const {return m_projectDir.filePath("project.json");};
+    QString structureFile() const {return m_projectDir.filePath("structure.json");};
+    QString contentIndexFile() const {return m_projectDir.filePath("content.json");};
+    QDir    contentDir() const {return m_contentDir;};
 
     // Error Handling
     bool hasError() const {return !m_lastError.isEmpty();};
     QString lastError() const {return m_lastError;};
 
+    // Static Methods
+    static bool cloneFile(const QString &source, const QString &target);
+    static QString contentFileName(const QUuid &handle);
+
 private:
     bool readJson(const QString &filePath, QJsonObject &fileData, bool required);
     bool writeJson(const QString &filePath, const QJsonObject &fileData);
@@ -22,6 +22,7 @@
 #include "collett.h"
 #include "edititem.h"
 #include "node.h"
+#include "projectmodel.h"
 
 #include <QDialog>
 #include <QDialogButtonBox>
@@ -77,11 +78,18 @@ EditItemDialog::~EditItemDialog() {
     qDebug() << "Destructor: EditItemDialog";
 }
 
-void EditItemDialog::editNode(QWidget *parent, Node *node) {
+/**!
+ * @brief Open the dialog for a node and rename it through the model.
+ *
+ * @param parent The parent widget.
+ * @param model  The project model, which records the rename for undo.
+ * @param node   The node to edit.
+ */
+void EditItemDialog::editNode(QWidget *parent, ProjectModel *model, Node *node) {
     QPointer<EditItemDialog> dialog(new EditItemDialog(parent, node));
     dialog->exec();
     if (dialog->result() == QDialog::Accepted) {
-        node->setName(dialog->m_titleValue->text());
+        model->renameNode(node, dialog->m_titleValue->text());
     }
     dialog->deleteLater();
 }
@@ -31,6 +31,7 @@
 namespace Collett {
 
 class Node;
+class ProjectModel;
 class EditItemDialog : public QDialog
 {
     Q_OBJECT
@@ -39,7 +40,7 @@ public:
     explicit EditItemDialog(QWidget *parent, Node *node);
     ~EditItemDialog();
 
-    static void editNode(QWidget *parent, Node *node);
+    static void editNode(QWidget *parent, ProjectModel *model, Node *node);
 
 private:
     QLineEdit *m_titleValue;
@@ -0,0 +1,166 @@
+/*
+** Collett – Quick Open Dialog Class
+** =================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "collett.h"
+#include "icons.h"
+#include "nameindex.h"
+#include "node.h"
+#include "quickopen.h"
+#include "theme.h"
+#include "tree.h"
+
+#include <QCoreApplication>
+#include <QDialog>
+#include <QEvent>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QListWidgetItem>
+#include <QPointer>
+#include <QStringList>
+#include <QUuid>
+#include <QVBoxLayout>
+#include <QWidget>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace Collett {
+
+// Constructor/Destructor
+// ======================
+
+QuickOpenDialog::QuickOpenDialog(QWidget *parent, Tree *tree) : QDialog(parent) {
+
+    m_tree = tree;
+
+    this->setWindowTitle(tr("Go to Project Item"));
+
+    m_searchValue = new QLineEdit(this);
+    m_searchValue->setPlaceholderText(tr("Type to search item names"));
+    m_searchValue->setClearButtonEnabled(true);
+    m_searchValue->installEventFilter(this);
+
+    m_resultList = new QListWidget(this);
+    m_resultList->setUniformItemSizes(true);
+    m_resultList->setIconSize(Theme::instance()->baseIconSize());
+
+    QVBoxLayout *outerBox = new QVBoxLayout();
+    outerBox->addWidget(m_searchValue);
+    outerBox->addWidget(m_resultList);
+    outerBox->setSpacing(6);
+
+    this->setLayout(outerBox);
+    this->setMinimumWidth(400);
+    this->setMinimumHeight(300);
+
+    this->connect(m_searchValue, &QLineEdit::textChanged, this, &QuickOpenDialog::updateResults);
+    this->connect(m_searchValue, &QLineEdit::returnPressed, this, &QDialog::accept);
+    this->connect(m_resultList, &QListWidget::itemActivated, this, &QDialog::accept);
+}
+
+QuickOpenDialog::~QuickOpenDialog() {
+    qDebug() << "Destructor: QuickOpenDialog";
+}
+
+/**!
+ * @brief Open the dialog and return the handle of the selected item.
+ *
+ * @param parent The parent widget.
+ * @param tree   The project tree to search.
+ * @return QUuid The handle of the selected item, or a null handle.
+ */
+QUuid QuickOpenDialog::selectItem(QWidget *parent, Tree *tree) {
+    QUuid handle;
+    if (!tree) return handle;
+    QPointer<QuickOpenDialog> dialog(new QuickOpenDialog(parent, tree));
+    dialog->exec();
+    if (dialog->result() == QDialog::Accepted) {
+        handle = dialog->selectedHandle();
+    }
+    dialog->deleteLater();
+    return handle;
+}
+
+// Events
+// ======
+
+/**!
+ * @brief Forward navigation keys from the search box to the result list.
+ */
+bool QuickOpenDialog::eventFilter(QObject *object, QEvent *event) {
+    if (object == m_searchValue && event->type() == QEvent::KeyPress) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        switch (keyEvent->key()) {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QCoreApplication::sendEvent(m_resultList, event);
+            return true;
+        default:
+            break;
+        }
+    }
+    return QDialog::eventFilter(object, event);
+}
+
+// Private Methods
+// ===============
+
+QUuid QuickOpenDialog::selectedHandle() const {
+    QListWidgetItem *item = m_resultList->currentItem();
+    if (item) {
+        return item->data(Qt::UserRole).toUuid();
+    }
+    return QUuid();
+}
+
+// Private Slots
+// =============
+
+void QuickOpenDialog::updateResults(const QString &text) {
+
+    m_resultList->clear();
+
+    Icons *icons = Theme::instance()->icons();
+    QSize iconSize = m_resultList->iconSize();
+    QList<NameIndex::Match> matches = m_tree->nameIndex().search(text, QUICK_OPEN_LIMIT);
+    for (const NameIndex::Match &match : std::as_const(matches)) {
+        Node *node = m_tree->node(match.handle);
+        if (!node) continue;
+
+        QStringList path;
+        for (Node *parent = node->parent(); parent && parent->parent(); parent = parent->parent()) {
+            path.prepend(parent->name());
+        }
+
+        QListWidgetItem *item = new QListWidgetItem(m_resultList);
+        item->setText(node->name());
+        item->setToolTip(path.join(" / "_L1));
+        item->setIcon(icons->getProjectIcon(node->itemType(), node->itemClass(), node->itemLevel(), iconSize));
+        item->setData(Qt::UserRole, match.handle);
+    }
+    if (m_resultList->count() > 0) {
+        m_resultList->setCurrentRow(0);
+    }
+}
+
+} // namespace Collett
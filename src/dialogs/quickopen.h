@@ -0,0 +1,68 @@
+/*
+** Collett – Quick Open Dialog Class
+** =================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_QUICK_OPEN_H
+#define COLLETT_QUICK_OPEN_H
+
+#include "collett.h"
+
+#include <QDialog>
+#include <QEvent>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QObject>
+#include <QString>
+#include <QUuid>
+#include <QWidget>
+
+#define QUICK_OPEN_LIMIT 50
+
+namespace Collett {
+
+class Tree;
+class QuickOpenDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit QuickOpenDialog(QWidget *parent, Tree *tree);
+    ~QuickOpenDialog();
+
+    static QUuid selectItem(QWidget *parent, Tree *tree);
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event) override;
+
+private:
+    Tree        *m_tree;
+    QLineEdit   *m_searchValue;
+    QListWidget *m_resultList;
+
+    // Methods
+    QUuid selectedHandle() const;
+
+private slots:
+    void updateResults(const QString &text);
+
+};
+} // namespace Collett
+
+#endif // COLLETT_QUICK_OPEN_H
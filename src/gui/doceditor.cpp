@@ -0,0 +1,715 @@
+/*
+** Collett – GUI Document Editor Class
+** ===================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "counting.h"
+#include "doceditor.h"
+#include "dochighlighter.h"
+#include "document.h"
+#include "piecetable.h"
+#include "settings.h"
+
+#include <QAbstractTextDocumentLayout>
+#include <QAction>
+#include <QContextMenuEvent>
+#include <QFontMetricsF>
+#include <QKeyEvent>
+#include <QKeySequence>
+#include <QList>
+#include <QMenu>
+#include <QPoint>
+#include <QRect>
+#include <QRectF>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QSignalBlocker>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextBlockUserData>
+#include <QTextDocument>
+#include <QtMath>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace Collett {
+
+// Block Counts
+// The counts of an editor block. When an edit removes the block, its counts
+// are subtracted from the document totals.
+class BlockCounts : public QTextBlockUserData
+{
+public:
+    explicit BlockCounts(GuiDocEditor *editor) : m_editor(editor) {};
+    ~BlockCounts() {if (m_editor) m_editor->releaseCounts(counts);};
+
+    NodeCounts counts = {0, 0, 0};
+
+private:
+    QPointer<GuiDocEditor> m_editor;
+};
+
+// Constructor/Destructor
+// ======================
+
+GuiDocEditor::GuiDocEditor(QWidget *parent) : QTextEdit(parent) {
+
+    this->setAcceptRichText(false);
+    this->setReadOnly(true);
+
+    // The undo history is kept by the document in document coordinates, as
+    // the editor content is replaced whenever the window moves
+    this->setUndoRedoEnabled(false);
+
+    // The built-in scroll bar only spans the window, so it is replaced by
+    // one that spans the whole document
+    m_scrollBar = new QScrollBar(Qt::Vertical, this);
+    this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    this->setViewportMargins(0, 0, m_scrollBar->sizeHint().width(), 0);
+
+    connect(this->document(), &QTextDocument::contentsChange, this, &GuiDocEditor::onContentsChange);
+    connect(this, &QTextEdit::textChanged, this, &GuiDocEditor::onTextChanged);
+    connect(this->verticalScrollBar(), &QScrollBar::valueChanged, this, &GuiDocEditor::onScrollValueChanged);
+    connect(this->verticalScrollBar(), &QScrollBar::rangeChanged, this, &GuiDocEditor::updateScrollBar);
+    connect(m_scrollBar, &QScrollBar::valueChanged, this, &GuiDocEditor::onDocumentScrollChanged);
+
+    // The highlighter must be connected after the editor, so that the edit
+    // is mirrored before the highlighter reports its format changes
+    m_highlighter = new GuiDocHighlighter(this->document());
+    this->updateTextFormat();
+}
+
+GuiDocEditor::~GuiDocEditor() {
+    qDebug() << "Destructor: GuiDocEditor";
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Show a document in the editor.
+ *
+ * The window is loaded around the paragraph that was at the top of the view
+ * when the document was last closed, and the cursor and scroll position are
+ * restored.
+ *
+ * @param document The document to show.
+ */
+void GuiDocEditor::openDocument(Document *document) {
+    if (m_document && document != m_document) this->closeDocument();
+    m_document = document;
+    if (m_document) {
+        Document::ViewState state = m_document->viewState();
+        this->setReadOnly(false);
+        this->estimateHeights();
+        this->loadWindow(state.topLine - EDITOR_SHIFT_LINES);
+        this->restoreViewState(state);
+    } else {
+        this->closeDocument();
+    }
+}
+
+/**!
+ * @brief Undo the last edit of the document.
+ *
+ * The edit may be outside the window, so the window is reloaded around the
+ * paragraph at the top of the view, and the cursor is put after the
+ * restored text.
+ */
+void GuiDocEditor::undoEdit() {
+    if (!m_document) return;
+    this->reloadAt(m_document->undo());
+}
+
+void GuiDocEditor::redoEdit() {
+    if (!m_document) return;
+    this->reloadAt(m_document->redo());
+}
+
+void GuiDocEditor::closeDocument() {
+    if (m_document) m_document->setViewState(this->viewState());
+    m_syncing = true;
+    this->clear();
+    m_syncing = false;
+    m_document = nullptr;
+    m_first = 0;
+    m_length = 0;
+    m_dirtyFirst = -1;
+    m_dirtyLast = -1;
+    m_blocks = 0;
+    m_heights.clear();
+    this->setReadOnly(true);
+    this->updateScrollBar();
+}
+
+// Public Slots
+// ============
+
+void GuiDocEditor::updateTextFormat() {
+    m_format = Settings::instance()->textFormat();
+    m_syncing = true;
+    this->document()->setDefaultFont(m_format.charParagraph.font());
+    this->formatBlocks(0, this->document()->blockCount() - 1, false);
+    m_highlighter->updateFormats();
+    m_syncing = false;
+}
+
+// Private Slots
+// =============
+
+/**!
+ * @brief Mirror an edit in the editor to the document.
+ *
+ * The editor text maps one to one onto the document text from the first
+ * line of the window, with block separators in place of newlines. The
+ * reported counts may include the final block separator, so the removed
+ * length is derived from the change in window length instead.
+ *
+ * Only the touched blocks are recounted, and the difference is applied to
+ * the document counts.
+ *
+ * The highlighter reports its format changes as a change of equal length,
+ * so such a change is skipped if the text already matches the document.
+ */
+void GuiDocEditor::onContentsChange(int position, int charsRemoved, int charsAdded) {
+    if (m_syncing || !m_document) return;
+
+    QTextDocument *doc = this->document();
+    qsizetype length = doc->characterCount() - 1;
+    qsizetype added = qBound<qsizetype>(0, charsAdded, length - position);
+    qsizetype removed = qMax<qsizetype>(0, m_length - (length - added));
+
+    QTextCursor cursor(doc);
+    cursor.setPosition(position);
+    cursor.setPosition(position + added, QTextCursor::KeepAnchor);
+    QString text = cursor.selectedText();
+    text.replace(QChar::ParagraphSeparator, u'\n');
+
+    qsizetype offset = m_document->content().lineStart(m_first) + position;
+    if (charsRemoved == charsAdded && length == m_length && m_document->content().text(offset, added) == text) {
+        return;
+    }
+
+    m_document->replace(offset, removed, text);
+    m_length = length;
+
+    int first = doc->findBlock(position).blockNumber();
+    int last = doc->findBlock(position + added).blockNumber();
+    m_dirtyFirst = m_dirtyFirst < 0 ? first : qMin(m_dirtyFirst, first);
+    m_dirtyLast = qMax(m_dirtyLast, last);
+
+    this->countBlocks(first, last, true);
+    if (m_delta.characters != 0 || m_delta.words != 0 || m_delta.paragraphs != 0) {
+        m_document->addCounts(m_delta);
+        m_delta = {0, 0, 0};
+        emit countsChanged(m_document->handle(), m_document->counts());
+    }
+}
+
+/**!
+ * @brief Restyle the blocks touched by the last edit.
+ */
+void GuiDocEditor::onTextChanged() {
+    if (m_syncing || m_dirtyFirst < 0) return;
+    m_syncing = true;
+    this->formatBlocks(m_dirtyFirst, m_dirtyLast, true);
+    m_syncing = false;
+    this->measureBlocks(m_dirtyFirst, m_dirtyLast);
+    m_dirtyFirst = -1;
+    m_dirtyLast = -1;
+    this->updateScrollBar();
+}
+
+void GuiDocEditor::onScrollValueChanged(int value) {
+    if (m_syncing || !m_document) return;
+
+    QScrollBar *bar = this->verticalScrollBar();
+    qsizetype last = m_first + this->document()->blockCount();
+    if (value <= bar->pageStep() && m_first > 0) {
+        this->shiftWindow(m_first - EDITOR_SHIFT_LINES);
+    } else if (value >= bar->maximum() - bar->pageStep() && last < m_document->content().lineCount()) {
+        this->shiftWindow(m_first + EDITOR_SHIFT_LINES);
+    }
+    this->updateScrollBar();
+}
+
+/**!
+ * @brief Scroll to a position in the whole document.
+ *
+ * Positions inside the window are scrolled to directly. Anything else loads
+ * a new window around the line at that position.
+ *
+ * @param value The position from the top of the document.
+ */
+void GuiDocEditor::onDocumentScrollChanged(int value) {
+    if (m_syncing || !m_document) return;
+
+    QScrollBar *bar = this->verticalScrollBar();
+    qint64 offset = value - m_heights.top(m_first);
+    if (offset >= 0 && offset <= bar->maximum()) {
+        bar->setValue(static_cast<int>(offset));
+        return;
+    }
+
+    qsizetype line = m_heights.lineAt(value);
+    int lineOffset = static_cast<int>(value - m_heights.top(line));
+    this->loadWindow(line - EDITOR_SHIFT_LINES);
+    this->scrollToLine(line, lineOffset);
+}
+
+/**!
+ * @brief Update the document scroll bar from the window position.
+ */
+void GuiDocEditor::updateScrollBar() {
+    QSignalBlocker blocker(m_scrollBar);
+    if (!m_document) {
+        m_scrollBar->setRange(0, 0);
+        return;
+    }
+
+    QScrollBar *bar = this->verticalScrollBar();
+    int page = this->viewport()->height();
+    qint64 total = m_heights.total();
+    m_scrollBar->setRange(0, static_cast<int>(qMax<qint64>(0, total - page)));
+    m_scrollBar->setPageStep(page);
+    m_scrollBar->setSingleStep(bar->singleStep());
+    m_scrollBar->setValue(static_cast<int>(m_heights.top(m_first) + bar->value()));
+}
+
+// Protected Methods
+// =================
+
+void GuiDocEditor::keyPressEvent(QKeyEvent *event) {
+    if (event->matches(QKeySequence::Undo)) {
+        this->undoEdit();
+    } else if (event->matches(QKeySequence::Redo)) {
+        this->redoEdit();
+    } else {
+        QTextEdit::keyPressEvent(event);
+    }
+}
+
+/**!
+ * @brief Show the standard context menu with the document undo history.
+ */
+void GuiDocEditor::contextMenuEvent(QContextMenuEvent *event) {
+    QMenu *menu = this->createStandardContextMenu(event->pos());
+    for (QAction *action : menu->actions()) {
+        if (action->objectName() == "edit-undo"_L1) {
+            action->setEnabled(m_document && m_document->canUndo());
+            connect(action, &QAction::triggered, this, &GuiDocEditor::undoEdit);
+        } else if (action->objectName() == "edit-redo"_L1) {
+            action->setEnabled(m_document && m_document->canRedo());
+            connect(action, &QAction::triggered, this, &GuiDocEditor::redoEdit);
+        }
+    }
+    menu->exec(event->globalPos());
+    delete menu;
+}
+
+void GuiDocEditor::resizeEvent(QResizeEvent *event) {
+    QTextEdit::resizeEvent(event);
+    QRect rect = this->contentsRect();
+    int width = m_scrollBar->sizeHint().width();
+    m_scrollBar->setGeometry(rect.right() - width + 1, rect.top(), width, rect.height());
+    if (m_document) this->measureBlocks(0, this->document()->blockCount() - 1);
+    this->updateScrollBar();
+}
+
+// Private Methods
+// ===============
+
+/**!
+ * @brief Materialise a window of paragraphs from the document.
+ *
+ * The undo history is kept by the document, so it is not affected.
+ *
+ * @param first The first line of the window.
+ */
+void GuiDocEditor::loadWindow(qsizetype first) {
+    if (!m_document) return;
+
+    const PieceTable &content = m_document->content();
+    first = qBound<qsizetype>(0, first, qMax<qsizetype>(0, content.lineCount() - EDITOR_WINDOW_LINES));
+
+    QTextDocument *doc = this->document();
+    m_syncing = true;
+    m_highlighter->setStartState(this->commentOpenAt(first));
+    doc->clear();
+    QTextCursor cursor(doc);
+    cursor.beginEditBlock();
+    this->appendLines(cursor, content.lines(first, EDITOR_WINDOW_LINES), false);
+    cursor.endEditBlock();
+    this->countBlocks(0, doc->blockCount() - 1, false);
+    m_first = first;
+    m_length = doc->characterCount() - 1;
+    m_blocks = doc->blockCount();
+    this->measureBlocks(0, m_blocks - 1);
+    m_syncing = false;
+    this->updateScrollBar();
+}
+
+/**!
+ * @brief Move the window of paragraphs.
+ *
+ * Paragraphs leaving the window are dropped from the editor and the ones
+ * entering it are read from the document, while the paragraph at the top of
+ * the viewport is kept in place.
+ *
+ * @param first The new first line of the window.
+ */
+void GuiDocEditor::shiftWindow(qsizetype first) {
+    if (!m_document) return;
+
+    const PieceTable &content = m_document->content();
+    qsizetype lines = content.lineCount();
+    first = qBound<qsizetype>(0, first, qMax<qsizetype>(0, lines - EDITOR_WINDOW_LINES));
+    if (first == m_first) return;
+
+    QTextDocument *doc = this->document();
+    qsizetype last = m_first + doc->blockCount();
+    qsizetype newLast = qMin<qsizetype>(first + EDITOR_WINDOW_LINES, lines);
+    if (first >= last || newLast <= m_first) {
+        this->loadWindow(first);
+        return;
+    }
+
+    QScrollBar *bar = this->verticalScrollBar();
+    QAbstractTextDocumentLayout *layout = doc->documentLayout();
+    QTextBlock anchor = this->cursorForPosition(QPoint(0, 0)).block();
+    qsizetype anchorLine = m_first + anchor.blockNumber();
+    int anchorOffset = bar->value() - qRound(layout->blockBoundingRect(anchor).top());
+
+    m_syncing = true;
+    if (first < m_first) {
+        m_highlighter->setStartState(this->commentOpenAt(first));
+    } else {
+        m_highlighter->setStartState(GuiDocHighlighter::endsInComment(doc->findBlockByNumber(first - m_first - 1)));
+    }
+    QTextCursor cursor(doc);
+    if (first < m_first) {
+        if (newLast < last) {
+            cursor.setPosition(doc->findBlockByNumber(newLast - m_first).position() - 1);
+            cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+        }
+        cursor.movePosition(QTextCursor::Start);
+        cursor.insertText(content.lines(first, m_first - first) + QChar(u'\n'));
+        this->formatBlocks(0, m_first - first, false);
+        this->countBlocks(0, m_first - first, false);
+    } else {
+        cursor.setPosition(doc->findBlockByNumber(first - m_first).position(), QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+        if (newLast > last) {
+            int from = doc->blockCount();
+            cursor.movePosition(QTextCursor::End);
+            cursor.beginEditBlock();
+            this->appendLines(cursor, content.lines(last, newLast - last), true);
+            cursor.endEditBlock();
+            this->countBlocks(from, doc->blockCount() - 1, false);
+        }
+    }
+    m_first = first;
+    m_length = doc->characterCount() - 1;
+    m_blocks = doc->blockCount();
+    this->measureBlocks(0, m_blocks - 1);
+
+    QTextBlock block = doc->findBlockByNumber(anchorLine - m_first);
+    if (block.isValid()) {
+        bar->setValue(qRound(layout->blockBoundingRect(block).top()) + anchorOffset);
+    }
+    m_syncing = false;
+    this->updateScrollBar();
+}
+
+/**!
+ * @brief Check if a block comment is open at the start of a line.
+ *
+ * The text above the line is scanned backwards in chunks for lines with
+ * comment markers. Whether such a line ends inside a comment may depend on
+ * whether it starts inside one, as the highlighter ignores the markers on %
+ * comment lines outside a comment. So the scan keeps the state at the line
+ * for both cases, and goes on upwards until they agree.
+ *
+ * @param line  The line number.
+ * @return bool True if the line starts inside a block comment.
+ */
+bool GuiDocEditor::commentOpenAt(qsizetype line) const {
+    const PieceTable &content = m_document->content();
+
+    // The state at the line if the scanned text starts outside or inside a
+    // comment. Lines without markers keep the state they start with.
+    bool fromPlain = false;
+    bool fromComment = true;
+
+    qsizetype pos = content.lineStart(line);
+    while (pos > 0) {
+        qsizetype start = qMax<qsizetype>(0, pos - EDITOR_SCAN_CHUNK);
+        QString text = content.text(start, pos - start);
+        QStringView view(text);
+        qsizetype next = start > 0 ? start + 1 : 0; // Overlap so no marker is split
+        while (!view.isEmpty()) {
+            qsizetype found = qMax(view.lastIndexOf(u"/*"), view.lastIndexOf(u"*/"));
+            if (found < 0) break;
+
+            qsizetype number = content.lineAt(start + found);
+            qsizetype lineStart = content.lineStart(number);
+            QString lineText = content.text(lineStart, content.lineEnd(number) - lineStart);
+            bool plain = GuiDocHighlighter::endsInComment(lineText, false) ? fromComment : fromPlain;
+            bool comment = GuiDocHighlighter::endsInComment(lineText, true) ? fromComment : fromPlain;
+            if (plain == comment) return plain;
+            fromPlain = plain;
+            fromComment = comment;
+
+            if (lineStart <= start) {
+                next = lineStart;
+                break;
+            }
+            view = view.first(lineStart - start);
+        }
+        pos = next;
+    }
+    return fromPlain;
+}
+
+/**!
+ * @brief Apply the paragraph and header formats to a range of blocks.
+ *
+ * @param first    The first block number.
+ * @param last     The last block number.
+ * @param changed  If true, only blocks that changed style are updated.
+ */
+void GuiDocEditor::formatBlocks(int first, int last, bool changed) {
+    QTextDocument *doc = this->document();
+    QTextCursor cursor(doc);
+    QTextBlock block = doc->findBlockByNumber(first);
+    while (block.isValid() && block.blockNumber() <= last) {
+        int level = Counting::headerLevel(block.text());
+        if (!changed || block.blockFormat().headingLevel() != level) {
+            cursor.setPosition(block.position());
+            cursor.setBlockFormat(this->blockFormat(level));
+        }
+        block = block.next();
+    }
+}
+
+/**!
+ * @brief Reload the window after the document changed under it.
+ *
+ * @param cursor The new cursor position in document coordinates, or -1 if
+ *               nothing changed.
+ */
+void GuiDocEditor::reloadAt(qsizetype cursor) {
+    if (cursor < 0) return;
+    Document::ViewState state = this->viewState();
+    state.cursor = cursor;
+    this->loadWindow(state.topLine - EDITOR_SHIFT_LINES);
+    this->restoreViewState(state);
+    emit countsChanged(m_document->handle(), m_document->counts());
+}
+
+/**!
+ * @brief Get the cursor and scroll position in document coordinates.
+ */
+Document::ViewState GuiDocEditor::viewState() const {
+    Document::ViewState state;
+    if (!m_document) return state;
+
+    QTextBlock top = this->cursorForPosition(QPoint(0, 0)).block();
+    QRectF rect = this->document()->documentLayout()->blockBoundingRect(top);
+    state.cursor = m_document->content().lineStart(m_first) + this->textCursor().position();
+    state.topLine = m_first + top.blockNumber();
+    state.topOffset = this->verticalScrollBar()->value() - qRound(rect.top());
+    return state;
+}
+
+/**!
+ * @brief Restore the cursor and scroll position after loading a window.
+ *
+ * @param state The position in document coordinates.
+ */
+void GuiDocEditor::restoreViewState(const Document::ViewState &state) {
+    QTextDocument *doc = this->document();
+    qsizetype offset = m_document->content().lineStart(m_first);
+    qsizetype position = qBound<qsizetype>(0, state.cursor - offset, doc->characterCount() - 1);
+
+    m_syncing = true;
+    QTextCursor cursor(doc);
+    cursor.setPosition(static_cast<int>(position));
+    this->setTextCursor(cursor);
+
+    m_syncing = false;
+    this->scrollToLine(state.topLine, state.topOffset);
+}
+
+/**!
+ * @brief Scroll the window so that a line is at the top of the view.
+ *
+ * @param line   The line in document coordinates.
+ * @param offset The offset in pixels from the top of the line.
+ */
+void GuiDocEditor::scrollToLine(qsizetype line, int offset) {
+    QTextDocument *doc = this->document();
+    QTextBlock block = doc->findBlockByNumber(static_cast<int>(line - m_first));
+    if (block.isValid()) {
+        QRectF rect = doc->documentLayout()->blockBoundingRect(block);
+        m_syncing = true;
+        this->verticalScrollBar()->setValue(qRound(rect.top()) + offset);
+        m_syncing = false;
+    }
+    this->updateScrollBar();
+}
+
+/**!
+ * @brief Estimate the height of every line of the document.
+ *
+ * Only the window is laid out by the editor, so the other lines get a
+ * height from their length, the font and the paragraph margins. The
+ * estimates are replaced by measured heights as the lines are loaded into
+ * the window.
+ */
+void GuiDocEditor::estimateHeights() {
+    const PieceTable &content = m_document->content();
+    QTextDocument *doc = this->document();
+    QFontMetricsF metrics(doc->defaultFont());
+    qreal width = qMax<qreal>(1.0, this->viewport()->width() - 2.0*doc->documentMargin());
+    qreal perLine = qMax<qreal>(1.0, width / metrics.averageCharWidth());
+    qreal lineHeight = metrics.lineSpacing();
+    qreal margins = m_format.blockParagraph.topMargin() + m_format.blockParagraph.bottomMargin();
+
+    QList<qint32> heights;
+    heights.reserve(content.lineCount());
+    qsizetype length = 0;
+    auto addLine = [&]() {
+        heights.append(qCeil(margins + lineHeight * qMax(1, qCeil(length / perLine))));
+        length = 0;
+    };
+    for (QStringView chunk : content.chunks()) {
+        qsizetype start = 0;
+        for (qsizetype i = chunk.indexOf(u'\n'); i >= 0; i = chunk.indexOf(u'\n', start)) {
+            length += i - start;
+            addLine();
+            start = i + 1;
+        }
+        length += chunk.size() - start;
+    }
+    addLine();
+    m_heights.setHeights(heights);
+}
+
+/**!
+ * @brief Store the measured heights of a range of blocks.
+ *
+ * If the number of blocks in the window has changed since the last call,
+ * the lines of the window are replaced in full.
+ *
+ * @param first The first block number.
+ * @param last  The last block number.
+ */
+void GuiDocEditor::measureBlocks(int first, int last) {
+    QTextDocument *doc = this->document();
+    QAbstractTextDocumentLayout *layout = doc->documentLayout();
+    if (doc->blockCount() != m_blocks) {
+        first = 0;
+        last = doc->blockCount() - 1;
+    }
+
+    QList<qint32> heights;
+    heights.reserve(last - first + 1);
+    QTextBlock block = doc->findBlockByNumber(first);
+    while (block.isValid() && block.blockNumber() <= last) {
+        heights.append(qCeil(layout->blockBoundingRect(block).height()));
+        block = block.next();
+    }
+    m_heights.replaceLines(m_first + first, doc->blockCount() != m_blocks ? m_blocks : heights.size(), heights);
+    m_blocks = doc->blockCount();
+}
+
+/**!
+ * @brief Append lines of text as formatted blocks.
+ *
+ * Each line is inserted as its own block with the block format for its
+ * header level, so the new blocks need no separate formatting pass. The
+ * caller should wrap this in an edit block, so that the layout and the
+ * highlighter only run once.
+ *
+ * @param cursor The cursor, at the end of the last block.
+ * @param text   The lines, separated by newlines.
+ * @param split  If true, the first line starts a new block, otherwise it
+ *               is added to the current block.
+ */
+void GuiDocEditor::appendLines(QTextCursor &cursor, QStringView text, bool split) {
+    for (QStringView line : text.tokenize(u'\n')) {
+        QTextBlockFormat format = this->blockFormat(Counting::headerLevel(line));
+        if (split) {
+            cursor.insertBlock(format);
+        } else {
+            cursor.setBlockFormat(format);
+        }
+        cursor.insertText(line.toString());
+        split = true;
+    }
+}
+
+QTextBlockFormat GuiDocEditor::blockFormat(int level) const {
+    switch (level) {
+        case 1: return m_format.blockHeader1;
+        case 2: return m_format.blockHeader2;
+        case 3: return m_format.blockHeader3;
+        case 4: return m_format.blockHeader4;
+        default: return m_format.blockParagraph;
+    }
+}
+
+/**!
+ * @brief Recount a range of blocks.
+ *
+ * @param first The first block number.
+ * @param last  The last block number.
+ * @param track If true, the change in counts is added to the pending delta.
+ */
+void GuiDocEditor::countBlocks(int first, int last, bool track) {
+    QTextBlock block = this->document()->findBlockByNumber(first);
+    while (block.isValid() && block.blockNumber() <= last) {
+        BlockCounts *data = static_cast<BlockCounts*>(block.userData());
+        if (!data) {
+            data = new BlockCounts(this);
+            block.setUserData(data);
+        }
+        NodeCounts counts = Counting::countParagraph(block.text());
+        if (track) {
+            m_delta += counts;
+            m_delta -= data->counts;
+        }
+        data->counts = counts;
+        block = block.next();
+    }
+}
+
+/**!
+ * @brief Subtract the counts of a block removed by an edit.
+ *
+ * Blocks dropped when the window moves are still part of the document, so
+ * they are ignored.
+ */
+void GuiDocEditor::releaseCounts(const NodeCounts &counts) {
+    if (!m_syncing) m_delta -= counts;
+}
+
+} // namespace Collett
@@ -0,0 +1,129 @@
+/*
+** Collett – GUI Document Editor Class
+** ===================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_GUI_DOC_EDITOR_H
+#define COLLETT_GUI_DOC_EDITOR_H
+
+#include "collett.h"
+#include "document.h"
+#include "heightindex.h"
+#include "settings.h"
+
+#include <QPointer>
+#include <QContextMenuEvent>
+#include <QKeyEvent>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QStringView>
+#include <QTextBlock>
+#include <QTextBlockFormat>
+#include <QTextCursor>
+#include <QTextEdit>
+#include <QWidget>
+
+#define EDITOR_WINDOW_LINES 600
+#define EDITOR_SHIFT_LINES 150
+#define EDITOR_SCAN_CHUNK 4096
+
+namespace Collett {
+
+class BlockCounts;
+class GuiDocHighlighter;
+class GuiDocEditor : public QTextEdit
+{
+    Q_OBJECT
+
+public:
+    explicit GuiDocEditor(QWidget *parent = nullptr);
+    ~GuiDocEditor();
+
+    // Methods
+    void openDocument(Document *document);
+    void closeDocument();
+
+    // Getters
+    Document *currentDocument() const {return m_document;};
+    Document::ViewState viewState() const;
+
+signals:
+    void countsChanged(const QUuid &handle, const NodeCounts &counts);
+
+public slots:
+    void updateTextFormat();
+    void undoEdit();
+    void redoEdit();
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onTextChanged();
+    void onScrollValueChanged(int value);
+    void onDocumentScrollChanged(int value);
+    void updateScrollBar();
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    QPointer<Document> m_document;
+    GuiDocHighlighter *m_highlighter;
+    Settings::TextFormat m_format;
+
+    // The editor only holds a window of paragraphs from the document. Line
+    // m_first of the document is the first block of the editor, and
+    // m_length is the length of the window text in the document.
+    qsizetype m_first = 0;
+    qsizetype m_length = 0;
+    bool      m_syncing = false;
+    int       m_dirtyFirst = -1;
+    int       m_dirtyLast = -1;
+
+    // The height of every line of the document, measured for the lines that
+    // have been in the window and estimated for the rest. The document scroll
+    // bar spans these heights. The window holds m_blocks lines of the index.
+    HeightIndex m_heights;
+    QScrollBar *m_scrollBar;
+    int         m_blocks = 0;
+
+    // Count changes not yet applied to the document
+    NodeCounts m_delta = {0, 0, 0};
+
+    // Methods
+    void loadWindow(qsizetype first);
+    void shiftWindow(qsizetype first);
+    void formatBlocks(int first, int last, bool changed);
+    bool commentOpenAt(qsizetype line) const;
+    void restoreViewState(const Document::ViewState &state);
+    void scrollToLine(qsizetype line, int offset);
+    void reloadAt(qsizetype cursor);
+    void estimateHeights();
+    void measureBlocks(int first, int last);
+    void appendLines(QTextCursor &cursor, QStringView text, bool split);
+    QTextBlockFormat blockFormat(int level) const;
+    void countBlocks(int first, int last, bool track);
+    void releaseCounts(const NodeCounts &counts);
+
+    friend class BlockCounts;
+};
+} // namespace Collett
+
+#endif // COLLETT_GUI_DOC_EDITOR_H
@@ -0,0 +1,239 @@
+/*
+** Collett – GUI Document Highlighter Class
+** ========================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "counting.h"
+#include "dochighlighter.h"
+#include "settings.h"
+#include "theme.h"
+
+#include <QFont>
+#include <QString>
+#include <QTextCharFormat>
+#include <QVarLengthArray>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace Collett {
+
+// Special Characters
+// Only these ASCII characters can start markup, so everything else is
+// skipped with a single table lookup.
+struct SpecialChars {
+    bool table[128] = {};
+    constexpr SpecialChars() {
+        table[int('*')] = true;
+        table[int('_')] = true;
+        table[int('~')] = true;
+        table[int('/')] = true;
+        table[int('@')] = true;
+    }
+    constexpr bool contains(char16_t c) const {return c < 128 && table[c];};
+};
+static constexpr SpecialChars specialChars;
+
+static inline bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == u'_' || c == u'-';
+}
+
+// Constructor/Destructor
+// ======================
+
+GuiDocHighlighter::GuiDocHighlighter(QTextDocument *document) : QSyntaxHighlighter(document) {
+    this->updateFormats();
+    connect(Theme::instance(), &Theme::themeChanged, this, &GuiDocHighlighter::updateFormats);
+}
+
+GuiDocHighlighter::~GuiDocHighlighter() {
+    qDebug() << "Destructor: GuiDocHighlighter";
+}
+
+// Public Slots
+// ============
+
+void GuiDocHighlighter::updateFormats() {
+    Settings::TextFormat format = Settings::instance()->textFormat();
+    m_base[0] = format.charParagraph;
+    m_base[1] = format.charHeader1;
+    m_base[2] = format.charHeader2;
+    m_base[3] = format.charHeader3;
+    m_base[4] = format.charHeader4;
+
+    Theme *theme = Theme::instance();
+    m_markupColor = theme->getColor(ThemeColor::FadedColor);
+    m_commentColor = theme->getColor(ThemeColor::FadedColor);
+    m_tagColor = theme->getColor(ThemeColor::Blue);
+
+    this->rehighlight();
+}
+
+// Protected Methods
+// =================
+
+/**!
+ * @brief Highlight a single block.
+ *
+ * The block is scanned once, marking each character with flags, and the
+ * formats are then applied per run of equal flags. Headers use the header
+ * formats for the whole block. Emphasis is **bold**, _italic_ and
+ * ~~strikethrough~~, comments are lines starting with % or text between
+ * slash-star and star-slash, and tags are words starting with @.
+ *
+ * @param text The text of the block.
+ */
+void GuiDocHighlighter::highlightBlock(const QString &text) {
+
+    const qsizetype n = text.size();
+    const int level = Counting::headerLevel(text);
+    QVarLengthArray<quint8, 256> flags(n);
+    std::fill(flags.begin(), flags.end(), 0);
+
+    auto mark = [&flags](qsizetype from, qsizetype to, quint8 flag) {
+        for (qsizetype k = from; k < to; ++k) flags[k] |= flag;
+    };
+
+    bool comment = this->currentBlock().previous().isValid()
+        ? this->previousBlockState() == CommentState : m_startComment;
+    qsizetype i = 0;
+    if (level > 0) {
+        mark(0, level + 1, MarkupFlag);
+        i = level + 1;
+    } else if (!comment && n > 0 && text.at(0) == u'%') {
+        mark(0, n, CommentFlag);
+        i = n;
+    }
+
+    qsizetype bold = -1;
+    qsizetype italic = -1;
+    qsizetype strike = -1;
+    while (i < n) {
+        if (comment) {
+            qsizetype end = text.indexOf("*/"_L1, i);
+            qsizetype stop = end < 0 ? n : end + 2;
+            mark(i, stop, CommentFlag);
+            comment = end < 0;
+            i = stop;
+            continue;
+        }
+
+        const char16_t c = text.at(i).unicode();
+        if (!specialChars.contains(c)) {
+            i++;
+            continue;
+        }
+
+        const QChar next = i + 1 < n ? text.at(i + 1) : QChar();
+        const QChar prev = i > 0 ? text.at(i - 1) : QChar();
+        if (c == u'/' && next == u'*') {
+            mark(i, i + 2, CommentFlag);
+            comment = true;
+            i += 2;
+        } else if ((c == u'*' && next == u'*') || (c == u'~' && next == u'~')) {
+            qsizetype &open = c == u'*' ? bold : strike;
+            if (open < 0) {
+                open = i;
+            } else {
+                mark(open + 2, i, c == u'*' ? BoldFlag : StrikeFlag);
+                mark(open, open + 2, MarkupFlag);
+                mark(i, i + 2, MarkupFlag);
+                open = -1;
+            }
+            i += 2;
+        } else if (c == u'_') {
+            if (italic < 0 && !isWordChar(prev) && !next.isNull() && !next.isSpace()) {
+                italic = i;
+            } else if (italic >= 0 && !prev.isSpace() && !isWordChar(next)) {
+                mark(italic + 1, i, ItalicFlag);
+                mark(italic, italic + 1, MarkupFlag);
+                mark(i, i + 1, MarkupFlag);
+                italic = -1;
+            }
+            i++;
+        } else if (c == u'@' && !isWordChar(prev)) {
+            qsizetype j = i + 1;
+            while (j < n && isWordChar(text.at(j))) j++;
+            if (j > i + 1) mark(i, j, TagFlag);
+            i = j;
+        } else {
+            i++;
+        }
+    }
+    this->setCurrentBlockState(comment ? CommentState : PlainState);
+
+    // Apply the formats, one run of equal flags at a time
+    qsizetype start = 0;
+    while (start < n) {
+        qsizetype end = start + 1;
+        while (end < n && flags[end] == flags[start]) end++;
+        if (level > 0 || flags[start] != 0) {
+            this->setFormat(start, end - start, this->charFormat(level, flags[start]));
+        }
+        start = end;
+    }
+}
+
+// Static Functions
+// ================
+
+/**!
+ * @brief Check if a paragraph ends inside a block comment.
+ *
+ * This follows the same rules as highlightBlock(), but only for the block
+ * comment markers, so the state can be found for text outside the editor.
+ *
+ * @param text    The text of the paragraph.
+ * @param comment True if the paragraph starts inside a block comment.
+ * @return bool   True if the paragraph ends inside a block comment.
+ */
+bool GuiDocHighlighter::endsInComment(QStringView text, bool comment) {
+    qsizetype i = 0;
+    int level = Counting::headerLevel(text);
+    if (level > 0) {
+        i = level + 1;
+    } else if (!comment && text.startsWith(u'%')) {
+        return false;
+    }
+    while (i < text.size()) {
+        qsizetype found = text.indexOf(comment ? u"*/" : u"/*", i);
+        if (found < 0) break;
+        comment = !comment;
+        i = found + 2;
+    }
+    return comment;
+}
+
+// Private Methods
+// ===============
+
+QTextCharFormat GuiDocHighlighter::charFormat(int level, quint8 flags) const {
+    QTextCharFormat format = m_base[level];
+    if (flags & BoldFlag) format.setFontWeight(QFont::Bold);
+    if (flags & ItalicFlag) format.setFontItalic(true);
+    if (flags & StrikeFlag) format.setFontStrikeOut(true);
+    if (flags & TagFlag) format.setForeground(m_tagColor);
+    if (flags & MarkupFlag) format.setForeground(m_markupColor);
+    if (flags & CommentFlag) {
+        format.setForeground(m_commentColor);
+        format.setFontItalic(true);
+    }
+    return format;
+}
+
+} // namespace Collett
@@ -0,0 +1,88 @@
+/*
+** Collett – GUI Document Highlighter Class
+** ========================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_GUI_DOC_HIGHLIGHTER_H
+#define COLLETT_GUI_DOC_HIGHLIGHTER_H
+
+#include "collett.h"
+
+#include <QString>
+#include <QSyntaxHighlighter>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextDocument>
+
+namespace Collett {
+
+class GuiDocHighlighter : public QSyntaxHighlighter
+{
+    Q_OBJECT
+
+public:
+    explicit GuiDocHighlighter(QTextDocument *document);
+    ~GuiDocHighlighter();
+
+    // Setters
+    void setStartState(bool comment) {m_startComment = comment;};
+
+    // Static Functions
+    static bool endsInComment(const QTextBlock &block) {return block.userState() == CommentState;};
+    static bool endsInComment(QStringView text, bool comment);
+
+public slots:
+    void updateFormats();
+
+protected:
+    void highlightBlock(const QString &text) override;
+
+private:
+    // The state carried from one block to the next. Only a block comment can
+    // span blocks, so a changed block only affects the blocks after it if it
+    // opens or closes a comment.
+    enum BlockState {
+        PlainState   = 0,
+        CommentState = 1,
+    };
+
+    enum CharFlag : quint8 {
+        BoldFlag    = 0x01,
+        ItalicFlag  = 0x02,
+        StrikeFlag  = 0x04,
+        MarkupFlag  = 0x08,
+        CommentFlag = 0x10,
+        TagFlag     = 0x20,
+    };
+
+    // The document only holds a window of paragraphs, so the first block
+    // takes its state from the paragraphs above the window
+    bool m_startComment = false;
+
+    // Base formats for paragraphs and headers 1 to 4
+    QTextCharFormat m_base[5];
+    QColor m_markupColor;
+    QColor m_commentColor;
+    QColor m_tagColor;
+
+    QTextCharFormat charFormat(int level, quint8 flags) const;
+};
+} // namespace Collett
+
+#endif // COLLETT_GUI_DOC_HIGHLIGHTER_H
@@ -0,0 +1,263 @@
+/*
+** Collett – GUI Project Delegate Class
+** ====================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "collett.h"
+#include "node.h"
+#include "projectdelegate.h"
+#include "theme.h"
+
+#include <QAbstractProxyModel>
+#include <QApplication>
+#include <QCache>
+#include <QFont>
+#include <QFontMetrics>
+#include <QIcon>
+#include <QLocale>
+#include <QModelIndex>
+#include <QPainter>
+#include <QPixmap>
+#include <QStaticText>
+#include <QStyle>
+#include <QStyleOptionViewItem>
+#include <QWidget>
+#include <QtMath>
+
+#define DELEGATE_CACHE_LIMIT 4096
+
+namespace Collett {
+
+// Constructor/Destructor
+// ======================
+
+GuiProjectDelegate::GuiProjectDelegate(QObject *parent) : QStyledItemDelegate(parent) {
+    m_theme = Theme::instance();
+    m_names.setMaxCost(DELEGATE_CACHE_LIMIT);
+    m_counts.setMaxCost(DELEGATE_CACHE_LIMIT);
+    connect(m_theme, &Theme::themeChanged, this, &GuiProjectDelegate::clearCache);
+}
+
+GuiProjectDelegate::~GuiProjectDelegate() {
+    qDebug() << "Destructor: GuiProjectDelegate";
+}
+
+// Painting
+// ========
+
+/**!
+ * @brief Paint a project item directly from its node.
+ *
+ * This bypasses the QVariant based data lookup and the generic item layout
+ * of QStyledItemDelegate. Elided names, word count labels and icon pixmaps
+ * are cached, so scrolling only draws already prepared items.
+ */
+void GuiProjectDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+
+    const Node *node = GuiProjectDelegate::indexNode(index);
+    if (!node) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, widget);
+
+    QPalette::ColorGroup group = QPalette::Normal;
+    if (!(option.state & QStyle::State_Enabled)) {
+        group = QPalette::Disabled;
+    } else if (!(option.state & QStyle::State_Active)) {
+        group = QPalette::Inactive;
+    }
+    QPalette::ColorRole role = option.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text;
+
+    int margin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    qreal dpr = painter->device()->devicePixelRatio();
+    QRect rect = option.rect.adjusted(margin, 0, -margin, 0);
+    QSize iconSize = option.decorationSize;
+    int iconTop = rect.top() + (rect.height() - iconSize.height())/2;
+    int textTop = rect.top() + (rect.height() - option.fontMetrics.height())/2;
+
+    painter->save();
+    painter->setFont(option.font);
+    painter->setPen(option.palette.color(group, role));
+
+    switch (index.column()) {
+        case 0: {
+            const QPixmap &pixmap = this->nodePixmap(node, iconSize, dpr);
+            if (!pixmap.isNull()) {
+                painter->drawPixmap(rect.left(), iconTop, pixmap);
+            }
+            int left = rect.left() + iconSize.width() + 2*margin;
+            int width = rect.right() - left + 1;
+            if (width > 0) {
+                painter->drawStaticText(left, textTop, this->nameText(node, option, width));
+            }
+            break;
+        }
+        case 1: {
+            const QStaticText &text = this->countText(node->counts().words, option);
+            int width = qCeil(text.size().width());
+            painter->drawStaticText(rect.right() - width + 1, textTop, text);
+            break;
+        }
+        case 2: {
+            const QPixmap &pixmap = this->statePixmap(node, iconSize, dpr);
+            if (!pixmap.isNull()) {
+                painter->drawPixmap(rect.left() + (rect.width() - iconSize.width())/2, iconTop, pixmap);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    painter->restore();
+}
+
+QSize GuiProjectDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+
+    const Node *node = GuiProjectDelegate::indexNode(index);
+    if (!node) {
+        return QStyledItemDelegate::sizeHint(option, index);
+    }
+
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    int margin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    int height = qMax(option.fontMetrics.height(), option.decorationSize.height()) + 2*margin;
+
+    switch (index.column()) {
+        case 0:
+            return QSize(
+                option.decorationSize.width() + option.fontMetrics.horizontalAdvance(node->name()) + 4*margin,
+                height
+            );
+        case 1:
+            return QSize(qCeil(this->countText(node->counts().words, option).size().width()) + 2*margin, height);
+        case 2:
+            return QSize(option.decorationSize.width() + 2*margin, height);
+        default:
+            return QSize(0, height);
+    }
+}
+
+// Public Slots
+// ============
+
+void GuiProjectDelegate::clearCache() {
+    m_names.clear();
+    m_counts.clear();
+    m_pixmaps.clear();
+}
+
+// Private Helpers
+// ===============
+
+/**!
+ * @brief Look up the node of an index, which may be from a proxy model.
+ */
+const Node *GuiProjectDelegate::indexNode(const QModelIndex &index) {
+    const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel*>(index.model());
+    QModelIndex source = proxy ? proxy->mapToSource(index) : index;
+    return static_cast<const Node*>(source.internalPointer());
+}
+
+/**!
+ * @brief Clear the text caches if the font or locale has changed.
+ */
+void GuiProjectDelegate::checkTextStyle(const QStyleOptionViewItem &option) const {
+    if (option.font != m_textFont || option.locale != m_textLocale) {
+        m_names.clear();
+        m_counts.clear();
+        m_textFont = option.font;
+        m_textLocale = option.locale;
+    }
+}
+
+/**!
+ * @brief Return the elided name of a node, laid out for painting.
+ *
+ * The layout is kept until the name or the available width changes. The
+ * least recently used layouts are dropped when the cache is full.
+ */
+const QStaticText &GuiProjectDelegate::nameText(const Node *node, const QStyleOptionViewItem &option, int width) const {
+    this->checkTextStyle(option);
+    NameText *entry = m_names.object(node);
+    if (entry && entry->width == width && entry->name == node->name()) {
+        return entry->text;
+    }
+
+    QFontMetrics metrics(option.font);
+    entry = new NameText();
+    entry->name = node->name();
+    entry->width = width;
+    entry->text = QStaticText(metrics.elidedText(entry->name, Qt::ElideRight, width));
+    entry->text.setTextFormat(Qt::PlainText);
+    entry->text.prepare(QTransform(), option.font);
+    m_names.insert(node, entry);
+    return entry->text;
+}
+
+/**!
+ * @brief Return the word count label for a count value.
+ */
+const QStaticText &GuiProjectDelegate::countText(qint32 count, const QStyleOptionViewItem &option) const {
+    this->checkTextStyle(option);
+    QStaticText *text = m_counts.object(count);
+    if (!text) {
+        text = new QStaticText(option.locale.toString(count));
+        text->setTextFormat(Qt::PlainText);
+        text->prepare(QTransform(), option.font);
+        m_counts.insert(count, text);
+    }
+    return *text;
+}
+
+const QPixmap &GuiProjectDelegate::nodePixmap(const Node *node, QSize size, qreal dpr) const {
+    quint64 key = (quint64(size.width()) << 48) | (quint64(qRound(100.0*dpr)) << 32)
+                | (quint64(node->itemType()) << 16) | (quint64(node->itemClass()) << 8) | quint64(node->itemLevel());
+    auto it = m_pixmaps.find(key);
+    if (it == m_pixmaps.end()) {
+        QIcon icon;
+        if (node->itemType() != ItemType::InvisibleRoot) {
+            icon = m_theme->icons()->getProjectIcon(node->itemType(), node->itemClass(), node->itemLevel(), size);
+        }
+        it = m_pixmaps.insert(key, icon.pixmap(size, dpr));
+    }
+    return it.value();
+}
+
+const QPixmap &GuiProjectDelegate::statePixmap(const Node *node, QSize size, qreal dpr) const {
+    bool checkable = node->itemType() == ItemType::FileType;
+    quint64 key = (quint64(size.width()) << 48) | (quint64(qRound(100.0*dpr)) << 32)
+                | (quint64(0xff) << 16) | (checkable ? 2 : 0) | (node->isActive() ? 1 : 0);
+    auto it = m_pixmaps.find(key);
+    if (it == m_pixmaps.end()) {
+        QIcon icon;
+        if (node->itemType() != ItemType::InvisibleRoot) {
+            icon = m_theme->icons()->getStateIcon(checkable, node->isActive(), size);
+        }
+        it = m_pixmaps.insert(key, icon.pixmap(size, dpr));
+    }
+    return it.value();
+}
+
+} // namespace Collett
@@ -0,0 +1,85 @@
+/*
+** Collett – GUI Project Delegate Class
+** ====================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_GUI_PROJECT_DELEGATE_H
+#define COLLETT_GUI_PROJECT_DELEGATE_H
+
+#include "collett.h"
+#include "node.h"
+#include "theme.h"
+
+#include <QCache>
+#include <QFont>
+#include <QHash>
+#include <QLocale>
+#include <QModelIndex>
+#include <QPainter>
+#include <QPixmap>
+#include <QStaticText>
+#include <QStyledItemDelegate>
+#include <QStyleOptionViewItem>
+
+namespace Collett {
+
+class GuiProjectDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit GuiProjectDelegate(QObject *parent = nullptr);
+    ~GuiProjectDelegate();
+
+    // Painting
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+public slots:
+    void clearCache();
+
+private:
+    struct NameText {
+        QString     name;
+        int         width;
+        QStaticText text;
+    };
+
+    Theme *m_theme;
+
+    // Cache
+    // The text layouts depend on the font and locale they were made for, so
+    // the text caches are cleared when either changes
+    mutable QCache<const Node*, NameText> m_names;
+    mutable QCache<qint32, QStaticText>   m_counts;
+    mutable QHash<quint64, QPixmap>       m_pixmaps;
+    mutable QFont                         m_textFont;
+    mutable QLocale                       m_textLocale;
+
+    // Helpers
+    static const Node *indexNode(const QModelIndex &index);
+    void checkTextStyle(const QStyleOptionViewItem &option) const;
+    const QStaticText &nameText(const Node *node, const QStyleOptionViewItem &option, int width) const;
+    const QStaticText &countText(qint32 count, const QStyleOptionViewItem &option) const;
+    const QPixmap &nodePixmap(const Node *node, QSize size, qreal dpr) const;
+    const QPixmap &statePixmap(const Node *node, QSize size, qreal dpr) const;
+};
+} // namespace Collett
+
+#endif // COLLETT_GUI_PROJECT_DELEGATE_H
@@ -57,4 +57,8 @@ void GuiProjectPanel::closeProjectTasks() {
     if (projectView) projectView->closeProjectTasks();
 }
 
+void GuiProjectPanel::loadedProjectTasks() {
+    if (projectView) projectView->loadedProjectTasks();
+}
+
 } // namespace Collett
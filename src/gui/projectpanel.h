@@ -42,6 +42,7 @@ public:
     // Methods
     void openProjectTasks();
     void closeProjectTasks();
+    void loadedProjectTasks();
 
     GuiProjectView *projectView = nullptr;
 
@@ -49,6 +50,7 @@ public slots:
     void createFile(const ItemLevel itemLevel) {if(projectView) projectView->createFile(itemLevel);};
     void createFolder() {if(projectView) projectView->createFolder();};
     void createRoot(const ItemClass itemClass) {if(projectView) projectView->createRoot(itemClass);};
+    void setNodeFilter(const NodeFilter &filter) {if(projectView) projectView->setNodeFilter(filter);};
 
 };
 } // namespace Collett
@@ -25,6 +25,7 @@
 #include "theme.h"
 
 #include <QAction>
+#include <QActionGroup>
 #include <QMenu>
 #include <QSize>
 #include <QToolBar>
@@ -47,12 +48,34 @@ GuiProjectToolBar::GuiProjectToolBar(GuiMain *parent) : QToolBar(parent) {
     actOpenProject = mnuProject->addAction(tr("Create or Open Project"));
     actSaveProject = mnuProject->addAction(tr("Save Project"));
     actCloseProject = mnuProject->addAction(tr("Close Project"));
+    actRecountProject = mnuProject->addAction(tr("Recount Project"));
 
     mnuProject->addSeparator();
+    mnuProject->addAction(parent->projectPanel->projectView->actUndo);
+    mnuProject->addAction(parent->projectPanel->projectView->actRedo);
     mnuProject->addAction(parent->projectPanel->projectView->actEditItem);
     mnuProject->addAction(parent->projectPanel->projectView->actDeleteItem);
+    mnuProject->addAction(parent->projectPanel->projectView->actDuplicate);
+    mnuProject->addAction(parent->projectPanel->projectView->actCopy);
+    mnuProject->addAction(parent->projectPanel->projectView->actPaste);
+    mnuProject->addAction(parent->projectPanel->projectView->actQuickOpen);
+    mnuProject->addAction(parent->projectPanel->projectView->actSortByName);
+    mnuProject->addAction(parent->projectPanel->projectView->actSortByWords);
+
+    mnuProject->addSeparator();
+    mnuTheme = mnuProject->addMenu(tr("Theme"));
+    grpTheme = new QActionGroup(mnuTheme);
+    QString current = Settings::instance()->guiTheme();
+    QMap<QString, QString> themes = Theme::availableThemes();
+    for (auto it = themes.constBegin(); it != themes.constEnd(); ++it) {
+        QString theme = it.key();
+        QAction *action = mnuTheme->addAction(it.value());
+        action->setCheckable(true);
+        action->setChecked(theme == current);
+        grpTheme->addAction(action);
+        connect(action, &QAction::triggered, this, [this, theme](){emit themeRequested(theme);});
+    }
 
-    btnProject->setIcon(m_theme->icons()->getIcon("menu_project", ThemeColor::Blue, size));
     btnProject->setMenu(mnuProject);
     btnProject->setPopupMode(QToolButton::InstantPopup);
     this->addWidget(btnProject);
@@ -66,10 +89,7 @@ GuiProjectToolBar::GuiProjectToolBar(GuiMain *parent) : QToolBar(parent) {
     this->addFileEntry(ItemLevel::PageLevel);
     this->addFileEntry(ItemLevel::NoteLevel);
 
-    QAction *actCreateFolder = mnuCreate->addAction(tr("Folder"));
-    actCreateFolder->setIcon(m_theme->icons()->getProjectIcon(
-        ItemType::FolderType, ItemClass::NovelClass, ItemLevel::PageLevel, m_theme->baseIconSize()
-    ));
+    actCreateFolder = mnuCreate->addAction(tr("Folder"));
     connect(actCreateFolder, &QAction::triggered, this, &GuiProjectToolBar::createFolderRequested);
 
     mnuCreateRoot = mnuCreate->addMenu(tr("Root Folder"));
@@ -83,33 +103,138 @@ GuiProjectToolBar::GuiProjectToolBar(GuiMain *parent) : QToolBar(parent) {
     mnuCreateRoot->addSeparator();
     this->addRootEntry(ItemClass::ArchiveClass);
 
-    btnCreate->setIcon(m_theme->icons()->getIcon("add", ThemeColor::Green, size));
     btnCreate->setMenu(mnuCreate);
     btnCreate->setPopupMode(QToolButton::InstantPopup);
     this->addWidget(btnCreate);
+
+    // Filter Button
+    btnFilter = new QToolButton(this);
+    btnFilter->setToolTip(tr("Filter Project Items"));
+    mnuFilter = new QMenu(btnFilter);
+
+    actFilterActive = mnuFilter->addAction(tr("Active Items Only"));
+    actFilterActive->setCheckable(true);
+    connect(actFilterActive, &QAction::triggered, this, &GuiProjectToolBar::emitNodeFilter);
+
+    mnuFilter->addSeparator();
+    this->addFilterLevelEntry(ItemLevel::SceneLevel);
+    this->addFilterLevelEntry(ItemLevel::ChapterLevel);
+    this->addFilterLevelEntry(ItemLevel::TitleLevel);
+    this->addFilterLevelEntry(ItemLevel::PageLevel);
+    this->addFilterLevelEntry(ItemLevel::NoteLevel);
+
+    mnuFilter->addSeparator();
+    this->addFilterClassEntry(ItemClass::NovelClass);
+    this->addFilterClassEntry(ItemClass::CharacterClass);
+    this->addFilterClassEntry(ItemClass::PlotClass);
+    this->addFilterClassEntry(ItemClass::LocationClass);
+    this->addFilterClassEntry(ItemClass::ObjectClass);
+    this->addFilterClassEntry(ItemClass::EntityClass);
+    this->addFilterClassEntry(ItemClass::CustomClass);
+    this->addFilterClassEntry(ItemClass::ArchiveClass);
+    this->addFilterClassEntry(ItemClass::TrashClass);
+
+    mnuFilter->addSeparator();
+    actFilterClear = mnuFilter->addAction(tr("Clear Filter"));
+    connect(actFilterClear, &QAction::triggered, this, [this](){emit nodeFilterRequested(NodeFilter());});
+
+    btnFilter->setMenu(mnuFilter);
+    btnFilter->setPopupMode(QToolButton::InstantPopup);
+    this->addWidget(btnFilter);
+
+    this->updateTheme();
+    connect(m_theme, &Theme::themeChanged, this, &GuiProjectToolBar::updateTheme);
 }
 
 GuiProjectToolBar::~GuiProjectToolBar() {
     qDebug() << "Destructor: GuiProjectToolBar";
 }
 
+// Public Slots
+// ============
+
+/**!
+ * @brief Apply the icons of the current theme to the buttons and menus.
+ */
+void GuiProjectToolBar::updateTheme() {
+
+    Icons *icons = m_theme->icons();
+    QSize size = m_theme->toolButtonIconSize();
+    QSize base = m_theme->baseIconSize();
+
+    btnProject->setIcon(icons->getIcon("menu_project", ThemeColor::Blue, size));
+    btnCreate->setIcon(icons->getIcon("add", ThemeColor::Green, size));
+    btnFilter->setIcon(icons->getIcon("checked", ThemeColor::Orange, size));
+
+    actCreateFolder->setIcon(icons->getProjectIcon(
+        ItemType::FolderType, ItemClass::NovelClass, ItemLevel::PageLevel, base
+    ));
+    for (auto [itemLevel, action] : m_fileActions.asKeyValueRange()) {
+        action->setIcon(icons->getProjectIcon(ItemType::FileType, ItemClass::NovelClass, itemLevel, base));
+    }
+    for (auto [itemClass, action] : m_rootActions.asKeyValueRange()) {
+        action->setIcon(icons->getProjectIcon(ItemType::RootType, itemClass, ItemLevel::PageLevel, base));
+    }
+    for (auto [itemLevel, action] : m_filterLevelActions.asKeyValueRange()) {
+        action->setIcon(icons->getProjectIcon(ItemType::FileType, ItemClass::NovelClass, itemLevel, base));
+    }
+    for (auto [itemClass, action] : m_filterClassActions.asKeyValueRange()) {
+        action->setIcon(icons->getProjectIcon(ItemType::RootType, itemClass, ItemLevel::PageLevel, base));
+    }
+}
+
+/**!
+ * @brief Update the filter menu to match the filter of the project view.
+ */
+void GuiProjectToolBar::updateFilter(const NodeFilter &filter) {
+    actFilterActive->setChecked(filter.activeOnly);
+    for (auto [itemLevel, action] : m_filterLevelActions.asKeyValueRange()) {
+        action->setChecked(filter.levelMask & (1u << itemLevel));
+    }
+    for (auto [itemClass, action] : m_filterClassActions.asKeyValueRange()) {
+        action->setChecked(filter.classMask & (1u << itemClass));
+    }
+}
+
 // Private Helpers
 // ===============
 
 void GuiProjectToolBar::addFileEntry(ItemLevel itemLevel) {
     QAction *action = mnuCreate->addAction(itemLevelNames(itemLevel));
-    action->setIcon(m_theme->icons()->getProjectIcon(
-        ItemType::FileType, ItemClass::NovelClass, itemLevel, m_theme->baseIconSize()
-    ));
     connect(action, &QAction::triggered, this, [=](){emit createFileRequested(itemLevel);});
+    m_fileActions.insert(itemLevel, action);
 }
 
 void GuiProjectToolBar::addRootEntry(ItemClass itemClass) {
     QAction *action = mnuCreateRoot->addAction(itemClassNames(itemClass));
-    action->setIcon(m_theme->icons()->getProjectIcon(
-        ItemType::RootType, itemClass, ItemLevel::PageLevel, m_theme->baseIconSize()
-    ));
     connect(action, &QAction::triggered, this, [=](){emit createRootRequested(itemClass);});
+    m_rootActions.insert(itemClass, action);
+}
+
+void GuiProjectToolBar::addFilterLevelEntry(ItemLevel itemLevel) {
+    QAction *action = mnuFilter->addAction(itemLevelNames(itemLevel));
+    action->setCheckable(true);
+    connect(action, &QAction::triggered, this, &GuiProjectToolBar::emitNodeFilter);
+    m_filterLevelActions.insert(itemLevel, action);
+}
+
+void GuiProjectToolBar::addFilterClassEntry(ItemClass itemClass) {
+    QAction *action = mnuFilter->addAction(itemClassNames(itemClass));
+    action->setCheckable(true);
+    connect(action, &QAction::triggered, this, &GuiProjectToolBar::emitNodeFilter);
+    m_filterClassActions.insert(itemClass, action);
+}
+
+void GuiProjectToolBar::emitNodeFilter() {
+    NodeFilter filter;
+    filter.activeOnly = actFilterActive->isChecked();
+    for (auto [itemLevel, action] : m_filterLevelActions.asKeyValueRange()) {
+        if (action->isChecked()) filter.levelMask |= 1u << itemLevel;
+    }
+    for (auto [itemClass, action] : m_filterClassActions.asKeyValueRange()) {
+        if (action->isChecked()) filter.classMask |= 1u << itemClass;
+    }
+    emit nodeFilterRequested(filter);
 }
 
 } // namespace Collett
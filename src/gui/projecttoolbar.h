@@ -26,6 +26,8 @@
 #include "theme.h"
 
 #include <QAction>
+#include <QActionGroup>
+#include <QMap>
 #include <QMenu>
 #include <QToolBar>
 #include <QToolButton>
@@ -46,25 +48,50 @@ signals:
     void createFileRequested(ItemLevel itemLevel);
     void createFolderRequested();
     void createRootRequested(ItemClass itemClass);
+    void themeRequested(const QString &theme);
+    void nodeFilterRequested(const NodeFilter &filter);
+
+public slots:
+    void updateTheme();
+    void updateFilter(const NodeFilter &filter);
 
 private:
     Theme *m_theme;
 
     // Project
-    QToolButton *btnProject;
-    QMenu       *mnuProject;
-    QAction     *actOpenProject;
-    QAction     *actSaveProject;
-    QAction     *actCloseProject;
+    QToolButton  *btnProject;
+    QMenu        *mnuProject;
+    QAction      *actOpenProject;
+    QAction      *actSaveProject;
+    QAction      *actCloseProject;
+    QAction      *actRecountProject;
+    QMenu        *mnuTheme;
+    QActionGroup *grpTheme;
 
     // Create New
     QToolButton *btnCreate;
     QMenu       *mnuCreate;
     QMenu       *mnuCreateRoot;
+    QAction     *actCreateFolder;
+
+    QMap<ItemLevel, QAction*> m_fileActions;
+    QMap<ItemClass, QAction*> m_rootActions;
+
+    // Filter
+    QToolButton *btnFilter;
+    QMenu       *mnuFilter;
+    QAction     *actFilterActive;
+    QAction     *actFilterClear;
+
+    QMap<ItemLevel, QAction*> m_filterLevelActions;
+    QMap<ItemClass, QAction*> m_filterClassActions;
 
     // Helpers
     void addFileEntry(ItemLevel itemLevel);
     void addRootEntry(ItemClass itemClass);
+    void addFilterLevelEntry(ItemLevel itemLevel);
+    void addFilterClassEntry(ItemClass itemClass);
+    void emitNodeFilter();
 
     friend class GuiMain;
 };
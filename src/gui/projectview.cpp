@@ -21,15 +21,22 @@
 
 #include "collett.h"
 #include "mtreeview.h"
+#include "projectcommands.h"
 #include "projectview.h"
 #include "projectmodel.h"
 #include "edititem.h"
+#include "quickopen.h"
 
 #include <QAbstractItemView>
 #include <QAction>
+#include <QClipboard>
+#include <QGuiApplication>
 #include <QHeaderView>
 #include <QItemSelectionModel>
+#include <QMessageBox>
+#include <QMimeData>
 #include <QTreeView>
+#include <QUndoStack>
 #include <QUuid>
 #include <QWidget>
 
@@ -51,6 +58,13 @@ GuiProjectView::GuiProjectView(QWidget *parent) : MTreeView(parent) {
     this->setHeaderHidden(true);
     this->setIndentation(m_theme->baseIconHeight());
 
+    // Paint items directly from the project nodes
+    m_delegate = new GuiProjectDelegate(this);
+    this->setItemDelegate(m_delegate);
+
+    // Filter items by class, level and active status
+    m_filter = new ProjectFilterModel(this);
+
     // Allow Move by Drag & Drop
     this->setDragEnabled(true);
     this->setDragDropMode(QAbstractItemView::InternalMove);
@@ -70,11 +84,55 @@ GuiProjectView::GuiProjectView(QWidget *parent) : MTreeView(parent) {
     actDeleteItem->setShortcutContext(Qt::WidgetShortcut);
     this->addAction(actDeleteItem);
 
+    actQuickOpen = new QAction(tr("Go to Project Item"), this);
+    actQuickOpen->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_P));
+    actQuickOpen->setShortcutContext(Qt::WindowShortcut);
+    this->addAction(actQuickOpen);
+
+    actUndo = new QAction(tr("Undo"), this);
+    actUndo->setShortcut(QKeySequence::Undo);
+    actUndo->setShortcutContext(Qt::WidgetShortcut);
+    actUndo->setEnabled(false);
+    this->addAction(actUndo);
+
+    actRedo = new QAction(tr("Redo"), this);
+    actRedo->setShortcut(QKeySequence::Redo);
+    actRedo->setShortcutContext(Qt::WidgetShortcut);
+    actRedo->setEnabled(false);
+    this->addAction(actRedo);
+
+    actDuplicate = new QAction(tr("Duplicate Project Items"), this);
+    actDuplicate->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_D));
+    actDuplicate->setShortcutContext(Qt::WidgetShortcut);
+    this->addAction(actDuplicate);
+
+    actCopy = new QAction(tr("Copy Project Items"), this);
+    actCopy->setShortcut(QKeySequence::Copy);
+    actCopy->setShortcutContext(Qt::WidgetShortcut);
+    this->addAction(actCopy);
+
+    actPaste = new QAction(tr("Paste Project Items"), this);
+    actPaste->setShortcut(QKeySequence::Paste);
+    actPaste->setShortcutContext(Qt::WidgetShortcut);
+    this->addAction(actPaste);
+
+    actSortByName = new QAction(tr("Sort Children by Name"), this);
+    actSortByWords = new QAction(tr("Sort Children by Word Count"), this);
+
     // Connect Signals
     this->connect(this, &GuiProjectView::expanded, this, &GuiProjectView::onNodeExpanded);
     this->connect(this, &GuiProjectView::collapsed, this, &GuiProjectView::onNodeCollapsed);
+    this->connect(this, &GuiProjectView::activated, this, &GuiProjectView::onNodeActivated);
     this->connect(actEditItem, &QAction::triggered, this, &GuiProjectView::editSelectedItem);
     this->connect(actDeleteItem, &QAction::triggered, this, &GuiProjectView::deleteSelectedItem);
+    this->connect(actQuickOpen, &QAction::triggered, this, &GuiProjectView::quickOpenItem);
+    this->connect(actUndo, &QAction::triggered, this, &GuiProjectView::undoEdit);
+    this->connect(actRedo, &QAction::triggered, this, &GuiProjectView::redoEdit);
+    this->connect(actDuplicate, &QAction::triggered, this, &GuiProjectView::duplicateSelectedItems);
+    this->connect(actCopy, &QAction::triggered, this, &GuiProjectView::copySelectedItems);
+    this->connect(actPaste, &QAction::triggered, this, &GuiProjectView::pasteItems);
+    this->connect(actSortByName, &QAction::triggered, this, [this](){sortSelectedChildren(SortKey::SortByName);});
+    this->connect(actSortByWords, &QAction::triggered, this, [this](){sortSelectedChildren(SortKey::SortByWords);});
 }
 
 GuiProjectView::~GuiProjectView() {
@@ -88,17 +146,30 @@ void GuiProjectView::openProjectTasks() {
     ProjectModel *model = this->getModel();
     if (model) {
         QItemSelectionModel *m = this->selectionModel();
-        this->setModel(model);
+        m_filter->setProjectTree(m_data->project()->tree());
+        this->setModel(m_filter);
         delete m;
+        QUndoStack *stack = model->undoStack();
+        this->connect(stack, &QUndoStack::canUndoChanged, actUndo, &QAction::setEnabled);
+        this->connect(stack, &QUndoStack::canRedoChanged, actRedo, &QAction::setEnabled);
+        actUndo->setEnabled(stack->canUndo());
+        actRedo->setEnabled(stack->canRedo());
         this->adjustHeaders();
-        this->restoreExpandedState();
     }
 }
 
+void GuiProjectView::loadedProjectTasks() {
+    this->restoreExpandedState();
+}
+
 void GuiProjectView::closeProjectTasks() {
     QItemSelectionModel *m = this->selectionModel();
     this->setModel(nullptr);
     delete m;
+    m_filter->setProjectTree(nullptr);
+    m_delegate->clearCache();
+    actUndo->setEnabled(false);
+    actRedo->setEnabled(false);
 }
 
 // Private Getters
@@ -114,11 +185,30 @@ ProjectModel *GuiProjectView::getModel() {
 Node *GuiProjectView::getNode(const QModelIndex &index) {
     if (m_data->hasProject()) {
         ProjectModel *model = m_data->project()->tree()->model();
-        if (model) return model->nodeAtIndex(index);
+        if (model) return model->nodeAtIndex(this->toSource(index));
     }
     return nullptr;
 }
 
+QModelIndex GuiProjectView::toSource(const QModelIndex &index) const {
+    return index.isValid() ? m_filter->mapToSource(index) : QModelIndex();
+}
+
+QModelIndex GuiProjectView::fromSource(const QModelIndex &index) const {
+    return index.isValid() ? m_filter->mapFromSource(index) : QModelIndex();
+}
+
+QModelIndexList GuiProjectView::selectedSourceRows() const {
+    QModelIndexList indexes;
+    QItemSelectionModel *selection = this->selectionModel();
+    if (selection) {
+        for (const QModelIndex &index : selection->selectedRows(0)) {
+            indexes.append(this->toSource(index));
+        }
+    }
+    return indexes;
+}
+
 // Private Methods
 // ===============
 
@@ -140,7 +230,7 @@ void GuiProjectView::restoreExpandedState() {
     if (model) {
         this->blockSignals(true);
         for (QModelIndex index : model->allExpanded()) {
-            this->setExpanded(index, true);
+            this->setExpanded(this->fromSource(index), true);
         }
         this->blockSignals(false);
     }
@@ -153,8 +243,8 @@ void GuiProjectView::createFile(const ItemLevel itemLevel) {
     ProjectModel *model = this->getModel();
     QModelIndex current = this->currentIndex();
     if (model && current.isValid()) {
-        Node *node = model->addFile(tr("New File"), itemLevel, current);
-        if (node) EditItemDialog::editNode(this, node);
+        Node *node = model->addFile(tr("New File"), itemLevel, this->toSource(current));
+        if (node) EditItemDialog::editNode(this, model, node);
     }
 }
 
@@ -162,8 +252,8 @@ void GuiProjectView::createFolder() {
     ProjectModel *model = this->getModel();
     QModelIndex current = this->currentIndex();
     if (model && current.isValid()) {
-        Node *node = model->addFolder(tr("New Folder"), current);
-        if (node) EditItemDialog::editNode(this, node);
+        Node *node = model->addFolder(tr("New Folder"), this->toSource(current));
+        if (node) EditItemDialog::editNode(this, model, node);
     }
 }
 
@@ -171,11 +261,34 @@ void GuiProjectView::createRoot(const ItemClass itemClass) {
     ProjectModel *model = this->getModel();
     QModelIndex current = this->currentIndex();
     if (model && current.isValid()) {
-        Node *node = model->addRoot(tr("New Root"), itemClass, current);
-        if (node) EditItemDialog::editNode(this, node);
+        Node *node = model->addRoot(tr("New Root"), itemClass, this->toSource(current));
+        if (node) EditItemDialog::editNode(this, model, node);
     }
 }
 
+/**!
+ * @brief Show only the project items matching a filter.
+ *
+ * While a filter is active, the whole tree is expanded so all matches are
+ * visible. The stored expanded state is restored when the filter is cleared.
+ *
+ * @param filter The filter, or an empty filter to show all items.
+ */
+void GuiProjectView::setNodeFilter(const NodeFilter &filter) {
+    m_filter->setNodeFilter(filter);
+    this->blockSignals(true);
+    if (filter.isEmpty()) {
+        this->collapseAll();
+    } else {
+        this->expandAll();
+    }
+    this->blockSignals(false);
+    if (filter.isEmpty()) {
+        this->restoreExpandedState();
+    }
+    emit nodeFilterChanged(filter);
+}
+
 // Private Slots
 // =============
 
@@ -189,16 +302,171 @@ void GuiProjectView::onNodeCollapsed(const QModelIndex &index) {
     if (node) node->setExpanded(false);
 }
 
+void GuiProjectView::onNodeActivated(const QModelIndex &index) {
+    Node *node = this->getNode(index);
+    if (node && node->isFileType()) emit openDocumentRequested(node->handle());
+}
+
 void GuiProjectView::editSelectedItem() {
+    ProjectModel *model = this->getModel();
     Node *node = this->getNode(this->currentIndex());
-    if (node){
-        EditItemDialog::editNode(this, node);
+    if (model && node) {
+        EditItemDialog::editNode(this, model, node);
     }
 }
 
-void GuiProjectView::deleteSelectedItem() {
+/**!
+ * @brief Undo the last project tree edit.
+ *
+ * Undoing a copy removes the copied items and their content, so if any of
+ * the copies have been edited since, the user is asked first.
+ */
+void GuiProjectView::undoEdit() {
+    ProjectModel *model = this->getModel();
+    if (!model) return;
+
+    QUndoStack *stack = model->undoStack();
+    auto clone = dynamic_cast<const CloneNodesCommand*>(stack->command(stack->index() - 1));
+    if (clone) {
+        emit saveDocumentsRequested();
+        if (clone->isModified()) {
+            QMessageBox::StandardButton answer = QMessageBox::question(
+                this, tr("Undo Copy"),
+                tr("The copied items have been edited. Undoing the copy will discard these changes. Continue?")
+            );
+            if (answer != QMessageBox::Yes) return;
+        }
+    }
+    stack->undo();
+}
+
+void GuiProjectView::redoEdit() {
+    ProjectModel *model = this->getModel();
+    if (model) model->undoStack()->redo();
+}
+
+void GuiProjectView::quickOpenItem() {
+    if (!m_data->hasProject()) return;
+    Tree *tree = m_data->project()->tree();
+    QUuid handle = QuickOpenDialog::selectItem(this, tree);
+    ProjectModel *model = this->getModel();
+    if (model && !handle.isNull()) {
+        QModelIndex source = model->indexFromHandle(handle);
+        if (source.isValid() && !this->fromSource(source).isValid()) {
+            this->setNodeFilter(NodeFilter());
+        }
+        QModelIndex index = this->fromSource(source);
+        if (index.isValid()) {
+            this->setCurrentIndex(index);
+            this->scrollTo(index, QAbstractItemView::PositionAtCenter);
+            this->setFocus();
+        }
+    }
+}
+
+/**!
+ * @brief Sort the children of the selected item.
+ *
+ * If the selected item has no children, its siblings are sorted instead.
+ * Names are sorted in ascending order and word counts in descending order.
+ */
+void GuiProjectView::sortSelectedChildren(SortKey sortKey) {
+    ProjectModel *model = this->getModel();
+    QModelIndex index = this->toSource(this->currentIndex());
+    if (!model || !index.isValid()) return;
+
+    index = index.siblingAtColumn(0);
+    Node *node = model->nodeAtIndex(index);
+    if (node && node->childCount() == 0) {
+        index = index.parent();
+    }
+    Qt::SortOrder order = sortKey == SortKey::SortByWords ? Qt::DescendingOrder : Qt::AscendingOrder;
+    model->sortChildren(index, sortKey, order);
+}
+
+/**!
+ * @brief Clone the selected items and place the clones after the current item.
+ *
+ * The open documents are saved first, since only the files are copied.
+ */
+void GuiProjectView::duplicateSelectedItems() {
+    ProjectModel *model = this->getModel();
+    Node *node = this->getNode(this->currentIndex());
+    if (!model || !node || node->isRootType() || !node->parent()) return;
+
+    QList<QUuid> handles;
+    for (const QModelIndex &index : this->selectedSourceRows()) {
+        Node *sNode = model->nodeAtIndex(index);
+        if (sNode) handles.append(sNode->handle());
+    }
+    if (handles.isEmpty()) handles.append(node->handle());
+    emit saveDocumentsRequested();
+    model->cloneNodes(handles, node->parent()->handle(), node->row() + 1);
+}
+
+void GuiProjectView::copySelectedItems() {
+    ProjectModel *model = this->getModel();
+    QModelIndexList indexes = this->selectedSourceRows();
+    if (model && !indexes.isEmpty()) {
+        QGuiApplication::clipboard()->setMimeData(model->mimeData(indexes));
+    }
+}
+
+/**!
+ * @brief Paste clones of the copied items.
+ *
+ * The clones are added as children of a selected folder, or after a selected
+ * file. Items that no longer exist in the project are skipped. The open
+ * documents are saved first, since only the files are copied.
+ */
+void GuiProjectView::pasteItems() {
+    ProjectModel *model = this->getModel();
     Node *node = this->getNode(this->currentIndex());
-    if (node){
+    const QMimeData *mimeData = QGuiApplication::clipboard()->mimeData();
+    if (!model || !node || !mimeData || !mimeData->hasFormat(PROJECT_ITEM_MIME)) return;
+    if (node->itemClass() == ItemClass::TrashClass) return;
+
+    QList<QUuid> handles = ProjectModel::decodeMimeHandles(mimeData);
+    emit saveDocumentsRequested();
+    if (node->isRootType() || node->isFolderType()) {
+        model->cloneNodes(handles, node->handle(), node->childCount());
+    } else if (node->parent()) {
+        model->cloneNodes(handles, node->parent()->handle(), node->row() + 1);
+    }
+}
+
+/**!
+ * @brief Delete the selected items.
+ *
+ * Items are first moved to the Trash. If all selected items are already in
+ * the Trash, they are deleted permanently after confirmation.
+ */
+void GuiProjectView::deleteSelectedItem() {
+    ProjectModel *model = this->getModel();
+    if (!model) return;
+
+    QList<QUuid> trash;
+    QList<QUuid> other;
+    for (const QModelIndex &index : this->selectedSourceRows()) {
+        Node *node = model->nodeAtIndex(index);
+        if (!node || node->isRootType()) continue;
+        if (node->itemClass() == ItemClass::TrashClass) {
+            trash.append(node->handle());
+        } else {
+            other.append(node->handle());
+        }
+    }
+
+    if (!other.isEmpty()) {
+        model->trashNodes(other);
+    } else if (!trash.isEmpty()) {
+        QMessageBox::StandardButton answer = QMessageBox::question(
+            this, tr("Delete Permanently"),
+            tr("Permanently delete %n item(s) and their content? This cannot be undone.", nullptr, trash.size())
+        );
+        if (answer == QMessageBox::Yes) {
+            model->destroyNodes(trash);
+        }
     }
 }
 
@@ -26,6 +26,8 @@
 #include "data.h"
 #include "theme.h"
 #include "mtreeview.h"
+#include "projectdelegate.h"
+#include "projectfilter.h"
 
 #include <QAction>
 #include <QModelIndex>
@@ -45,19 +47,35 @@ public:
     // Methods
     void openProjectTasks();
     void closeProjectTasks();
+    void loadedProjectTasks();
 
     // Actions
     QAction *actEditItem;
     QAction *actDeleteItem;
+    QAction *actQuickOpen;
+    QAction *actUndo;
+    QAction *actRedo;
+    QAction *actDuplicate;
+    QAction *actCopy;
+    QAction *actPaste;
+    QAction *actSortByName;
+    QAction *actSortByWords;
 
 private:
     // Singletons
     SharedData *m_data;
     Theme      *m_theme;
 
+    // Components
+    GuiProjectDelegate *m_delegate;
+    ProjectFilterModel *m_filter;
+
     // Getters
     ProjectModel *getModel();
     Node *getNode(const QModelIndex &index);
+    QModelIndex toSource(const QModelIndex &index) const;
+    QModelIndex fromSource(const QModelIndex &index) const;
+    QModelIndexList selectedSourceRows() const;
 
     // Methods
     void adjustHeaders();
@@ -67,12 +85,26 @@ public slots:
     void createFile(const ItemLevel itemLevel);
     void createFolder();
     void createRoot(const ItemClass itemClass);
+    void setNodeFilter(const NodeFilter &filter);
+
+signals:
+    void nodeFilterChanged(const NodeFilter &filter);
+    void openDocumentRequested(const QUuid &handle);
+    void saveDocumentsRequested();
 
 private slots:
     void onNodeExpanded(const QModelIndex &index);
     void onNodeCollapsed(const QModelIndex &index);
+    void onNodeActivated(const QModelIndex &index);
     void editSelectedItem();
     void deleteSelectedItem();
+    void quickOpenItem();
+    void undoEdit();
+    void redoEdit();
+    void duplicateSelectedItems();
+    void copySelectedItems();
+    void pasteItems();
+    void sortSelectedChildren(SortKey sortKey);
 
 };
 } // namespace Collett
@@ -20,8 +20,14 @@
 */
 
 #include "collett.h"
+#include "documentpool.h"
+#include "settings.h"
 #include "workpanel.h"
 
+#include <QThreadPool>
+#include <QTimer>
+#include <QUuid>
+#include <QVBoxLayout>
 #include <QWidget>
 
 namespace Collett {
@@ -30,10 +36,141 @@ namespace Collett {
 // ======================
 
 GuiWorkPanel::GuiWorkPanel(QWidget *parent) : QWidget(parent) {
+
+    m_data = SharedData::instance();
+
+    // Components
+    docEditor = new GuiDocEditor(this);
+
+    // Autosave
+    m_journalPool.setMaxThreadCount(1);
+    m_autoSave = new QTimer(this);
+    m_autoSave->setInterval(Settings::instance()->editorAutoSave() * 1000);
+    m_autoSave->start();
+
+    // Document Pool
+    m_pool = new DocumentPool(this);
+    m_pool->setBudget(qint64(Settings::instance()->editorCacheSize()) * 1048576);
+
+    // Assemble
+    QVBoxLayout *outerBox = new QVBoxLayout();
+    outerBox->setContentsMargins(0, 0, 0, 0);
+    outerBox->addWidget(docEditor, 1);
+
+    this->setLayout(outerBox);
+
+    // Connect Signals
+    connect(docEditor, &GuiDocEditor::countsChanged, this, &GuiWorkPanel::updateNodeCounts);
+    connect(m_autoSave, &QTimer::timeout, this, &GuiWorkPanel::autoSaveDocument);
 }
 
 GuiWorkPanel::~GuiWorkPanel() {
     qDebug() << "Destructor: GuiWorkPanel";
+    m_journalPool.waitForDone();
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Write all modified documents in the pool to their files.
+ *
+ * Pending journal writes are finished first, since a successful save
+ * removes the journal.
+ */
+bool GuiWorkPanel::saveDocuments() {
+    if (!m_data->hasProject()) return true;
+    m_journalPool.waitForDone();
+    return m_pool->saveAll(m_data->project()->store());
+}
+
+void GuiWorkPanel::closeDocuments() {
+    docEditor->closeDocument();
+    m_document = nullptr;
+    m_journalPool.waitForDone();
+    m_pool->clear(m_data->hasProject() ? m_data->project()->store() : nullptr);
+}
+
+// Public Slots
+// ============
+
+/**!
+ * @brief Show a document in the editor.
+ *
+ * The changes to the current document are journalled before it is put back
+ * in the pool. The pool may evict and save other documents to make room for
+ * the new one, so the journal writes must be done first.
+ *
+ * @param handle The handle of the document.
+ */
+void GuiWorkPanel::openDocument(const QUuid &handle) {
+    if (!m_data->hasProject()) return;
+    if (m_document && m_document->handle() == handle) return;
+
+    this->autoSaveDocument();
+    docEditor->closeDocument();
+    m_document = nullptr;
+    m_journalPool.waitForDone();
+
+    m_document = m_pool->acquire(handle, m_data->project()->store());
+    if (!m_document) return;
+    docEditor->openDocument(m_document);
+    this->updateNodeCounts(handle, m_document->counts());
+}
+
+/**!
+ * @brief Drop the documents of deleted nodes without saving them.
+ *
+ * The editor lets go of its document first if it is one of them, and the
+ * pending journal writes are finished so none are left to write after the
+ * files are removed.
+ *
+ * @param handles The handles of the deleted nodes.
+ */
+void GuiWorkPanel::removeDocuments(const QList<QUuid> &handles) {
+    if (m_document && handles.contains(m_document->handle())) {
+        docEditor->closeDocument();
+        m_document = nullptr;
+    }
+    m_journalPool.waitForDone();
+    for (const QUuid &handle : handles) {
+        m_pool->remove(handle);
+    }
+}
+
+// Private Slots
+// =============
+
+void GuiWorkPanel::updateNodeCounts(const QUuid &handle, const NodeCounts &counts) {
+    if (!m_data->hasProject()) return;
+    Node *node = m_data->project()->tree()->node(handle);
+    if (node) node->setCounts(counts);
+}
+
+/**!
+ * @brief Autosave the open document.
+ *
+ * Only the paragraphs changed since the last autosave are appended to the
+ * document journal, and the write is done on the journal thread. Once the
+ * journal grows past DOCUMENT_JOURNAL_LIMIT, the document is saved in full
+ * instead, which also clears the journal.
+ */
+void GuiWorkPanel::autoSaveDocument() {
+    if (!m_document || !m_document->hasJournalChanges() || !m_data->hasProject()) return;
+
+    Storage *store = m_data->project()->store();
+    if (m_document->journalSize() > DOCUMENT_JOURNAL_LIMIT) {
+        m_journalPool.waitForDone();
+        if (!m_document->save(store)) qWarning() << m_document->lastError();
+        return;
+    }
+
+    QString path = store->journalPath(m_document->handle());
+    bool restart = m_document->journalSize() == 0;
+    QByteArray records = m_document->takeJournalRecords();
+    m_journalPool.start([path, records, restart]() {
+        Document::appendJournal(path, records, restart);
+    });
 }
 
 } // namespace Collett
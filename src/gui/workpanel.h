@@ -23,7 +23,15 @@
 #define COLLETT_GUI_WORK_PANEL_H
 
 #include "collett.h"
+#include "data.h"
+#include "doceditor.h"
+#include "document.h"
+#include "documentpool.h"
 
+#include <QList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUuid>
 #include <QWidget>
 
 namespace Collett {
@@ -36,7 +44,36 @@ public:
     explicit GuiWorkPanel(QWidget *parent = nullptr);
     ~GuiWorkPanel();
 
+    // Methods
+    bool saveDocuments();
+    void closeDocuments();
+
+    // Components
+    GuiDocEditor *docEditor;
+
+public slots:
+    void openDocument(const QUuid &handle);
+    void removeDocuments(const QList<QUuid> &handles);
+
+private slots:
+    void updateNodeCounts(const QUuid &handle, const NodeCounts &counts);
+    void autoSaveDocument();
+
+private:
+    // Singletons
+    SharedData *m_data;
+
+    // The pool owns the documents, and m_document is the one in the editor
+    DocumentPool *m_pool;
+    Document     *m_document = nullptr;
+
+    // Autosave
+    // The journal writes run on a single thread, so they reach the file in
+    // the order they were queued.
+    QTimer      *m_autoSave;
+    QThreadPool  m_journalPool;
+
 };
 } // namespace Collett
 
-#endif // COLLETT_GUI_PROJECT_PANEL_H
+#endif // COLLETT_GUI_WORK_PANEL_H
@@ -25,7 +25,9 @@
 #include <QApplication>
 #include <QCloseEvent>
 #include <QMenu>
+#include <QMessageBox>
 #include <QSplitter>
+#include <QStatusBar>
 #include <QToolButton>
 
 using namespace Qt::Literals::StringLiterals;
@@ -58,20 +60,44 @@ GuiMain::GuiMain(QWidget *parent) : QMainWindow(parent) {
     // ToolBars
     projectToolBar = new GuiProjectToolBar(this);
 
+    // Status Bar
+    m_progress = new QProgressBar(this);
+    m_progress->setMaximumWidth(200);
+    m_progress->setTextVisible(false);
+    m_progress->setVisible(false);
+
+    m_cancelJob = new QToolButton(this);
+    m_cancelJob->setText(tr("Cancel"));
+    m_cancelJob->setAutoRaise(true);
+    m_cancelJob->setVisible(false);
+
     // Connect Signals
-    connect(m_data, &SharedData::projectLoaded, this, &GuiMain::updateTitle);
+    connect(m_data, &SharedData::projectLoadProgress, this, &GuiMain::onJobProgress);
+    connect(m_data, &SharedData::projectLoaded, this, &GuiMain::onProjectLoaded);
+    connect(m_data, &SharedData::projectLoadFailed, this, &GuiMain::onProjectLoadFailed);
+    connect(m_data, &SharedData::projectRecountProgress, this, &GuiMain::onJobProgress);
+    connect(m_data, &SharedData::projectRecountFinished, this, &GuiMain::onRecountFinished);
+    connect(m_cancelJob, &QToolButton::clicked, this, &GuiMain::onCancelJob);
 
     connect(projectToolBar->actOpenProject, &QAction::triggered, this, &GuiMain::onProjectOpen);
     connect(projectToolBar->actSaveProject, &QAction::triggered, this, &GuiMain::onProjectSave);
     connect(projectToolBar->actCloseProject, &QAction::triggered, this, &GuiMain::onProjectClose);
+    connect(projectToolBar->actRecountProject, &QAction::triggered, this, &GuiMain::onProjectRecount);
 
     connect(projectToolBar, &GuiProjectToolBar::createFileRequested, projectPanel, &GuiProjectPanel::createFile);
     connect(projectToolBar, &GuiProjectToolBar::createFolderRequested, projectPanel, &GuiProjectPanel::createFolder);
     connect(projectToolBar, &GuiProjectToolBar::createRootRequested, projectPanel, &GuiProjectPanel::createRoot);
+    connect(projectToolBar, &GuiProjectToolBar::themeRequested, m_theme, &Theme::switchTheme);
+    connect(projectToolBar, &GuiProjectToolBar::nodeFilterRequested, projectPanel, &GuiProjectPanel::setNodeFilter);
+    connect(projectPanel->projectView, &GuiProjectView::nodeFilterChanged, projectToolBar, &GuiProjectToolBar::updateFilter);
+    connect(projectPanel->projectView, &GuiProjectView::openDocumentRequested, workPanel, &GuiWorkPanel::openDocument);
+    connect(projectPanel->projectView, &GuiProjectView::saveDocumentsRequested, workPanel, &GuiWorkPanel::saveDocuments);
 
     // Assemble
     this->setCentralWidget(m_splitMain);
     this->addToolBar(projectToolBar);
+    this->statusBar()->addPermanentWidget(m_progress);
+    this->statusBar()->addPermanentWidget(m_cancelJob);
 
     // Apply Settings
     this->resize(m_settings->mainWindowSize());
@@ -87,24 +113,35 @@ GuiMain::~GuiMain() {
 
 void GuiMain::openProject(const QString &path) {
 
+    if (m_data->hasProject()) {
+        this->closeProject();
+    }
     m_data->openProject(path);
     if (!m_data->hasProject()) {
         return;
     }
+    connect(m_data->project()->tree()->model(), &ProjectModel::nodesRemoved, workPanel, &GuiWorkPanel::removeDocuments);
+    m_progress->setRange(0, 0);
+    m_progress->setVisible(true);
     projectPanel->openProjectTasks();
 }
 
 void GuiMain::saveProject() {
     if (m_data->hasProject()) {
+        workPanel->saveDocuments();
         m_data->saveProject();
     }
 }
 
 void GuiMain::closeProject() {
+    // The views must let go of the model before the project is torn down
+    workPanel->closeDocuments();
+    projectPanel->closeProjectTasks();
+    m_progress->setVisible(false);
+    m_cancelJob->setVisible(false);
     if (m_data->hasProject()) {
         m_data->closeProject();
     }
-    projectPanel->closeProjectTasks();
 }
 
 bool GuiMain::closeMain() {
@@ -150,4 +187,48 @@ void GuiMain::updateTitle() {
     }
 }
 
+void GuiMain::onProjectRecount() {
+    if (!m_data->hasProject()) return;
+
+    // The open document may have edits that are not yet on disk
+    workPanel->saveDocuments();
+    if (m_data->project()->recountProject()) {
+        m_progress->setRange(0, 0);
+        m_progress->setVisible(true);
+        m_cancelJob->setVisible(true);
+    }
+}
+
+void GuiMain::onProjectLoaded() {
+    m_progress->setVisible(false);
+    projectPanel->loadedProjectTasks();
+    this->updateTitle();
+}
+
+void GuiMain::onProjectLoadFailed(const QString &error) {
+    m_progress->setVisible(false);
+    if (!error.isEmpty()) {
+        QMessageBox::critical(this, tr("Open Project"), error);
+    }
+    // The signal is emitted by the project itself, so it must not be deleted here
+    QMetaObject::invokeMethod(this, &GuiMain::closeProject, Qt::QueuedConnection);
+}
+
+void GuiMain::onJobProgress(int value, int total) {
+    m_progress->setRange(0, total);
+    m_progress->setValue(value);
+}
+
+void GuiMain::onRecountFinished(bool completed) {
+    Q_UNUSED(completed);
+    m_progress->setVisible(false);
+    m_cancelJob->setVisible(false);
+}
+
+void GuiMain::onCancelJob() {
+    if (m_data->hasProject()) {
+        m_data->project()->cancelRecount();
+    }
+}
+
 } // namespace Collett
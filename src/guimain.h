@@ -31,7 +31,9 @@
 #include "workpanel.h"
 
 #include <QMainWindow>
+#include <QProgressBar>
 #include <QSplitter>
+#include <QToolButton>
 #include <QToolBar>
 
 namespace Collett {
@@ -64,7 +66,9 @@ private:
     Theme      *m_theme;
 
     // Layout
-    QSplitter *m_splitMain;
+    QSplitter    *m_splitMain;
+    QProgressBar *m_progress;
+    QToolButton  *m_cancelJob;
 
     // Events
     void closeEvent(QCloseEvent*);
@@ -74,7 +78,13 @@ private slots:
     void onProjectOpen();
     void onProjectSave() {saveProject();};
     void onProjectClose() {closeProject();};
+    void onProjectRecount();
     void updateTitle();
+    void onProjectLoaded();
+    void onProjectLoadFailed(const QString &error);
+    void onJobProgress(int value, int total);
+    void onRecountFinished(bool completed);
+    void onCancelJob();
 
 };
 } // namespace Collett
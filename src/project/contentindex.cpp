@@ -0,0 +1,201 @@
+/*
+** Collett – Content Index Class
+** =============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "contentindex.h"
+#include "storage.h"
+
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QUuid>
+#include <QtEndian>
+
+using namespace Qt::Literals::StringLiterals;
+
+#define XXH_PRIME64_1 0x9e3779b185ebca87ULL
+#define XXH_PRIME64_2 0xc2b2ae3d27d4eb4fULL
+#define XXH_PRIME64_3 0x165667b19e3779f9ULL
+#define XXH_PRIME64_4 0x85ebca77c2b2ae63ULL
+#define XXH_PRIME64_5 0x27d4eb2f165667c5ULL
+
+namespace Collett {
+
+static inline quint64 xxhRotate(quint64 value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline quint64 xxhRound(quint64 acc, quint64 input) {
+    acc += input * XXH_PRIME64_2;
+    acc = xxhRotate(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline quint64 xxhMerge(quint64 acc, quint64 value) {
+    acc ^= xxhRound(0, value);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+// Public Methods
+// ==============
+
+void ContentIndex::pack(QJsonObject &data) const {
+    QJsonObject jItems;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const Entry &entry = it.value();
+        QJsonObject jEntry;
+        jEntry["m:size"_L1] = entry.size;
+        jEntry["m:mtime"_L1] = entry.mtime;
+        jEntry["m:hash"_L1] = QString::number(entry.hash, 16);
+        jEntry["m:characters"_L1] = entry.counts.characters;
+        jEntry["m:words"_L1] = entry.counts.words;
+        jEntry["m:paragraphs"_L1] = entry.counts.paragraphs;
+        jItems[it.key().toString(QUuid::WithoutBraces)] = jEntry;
+    }
+    data["c:format"_L1] = "CollettContentIndex";
+    data["x:items"_L1] = jItems;
+}
+
+void ContentIndex::unpack(const QJsonObject &data) {
+    m_entries.clear();
+    const QJsonObject jItems = data.value("x:items"_L1).toObject();
+    m_entries.reserve(jItems.size());
+    for (auto it = jItems.constBegin(); it != jItems.constEnd(); ++it) {
+        QUuid handle(it.key());
+        if (handle.isNull() || !it.value().isObject()) continue;
+
+        const QJsonObject jEntry = it.value().toObject();
+        bool ok = false;
+        Entry entry;
+        entry.size = jEntry.value("m:size"_L1).toInteger(-1);
+        entry.mtime = jEntry.value("m:mtime"_L1).toInteger(-1);
+        entry.hash = jEntry.value("m:hash"_L1).toString().toULongLong(&ok, 16);
+        entry.counts.characters = jEntry.value("m:characters"_L1).toInt();
+        entry.counts.words = jEntry.value("m:words"_L1).toInt();
+        entry.counts.paragraphs = jEntry.value("m:paragraphs"_L1).toInt();
+        if (ok && entry.size >= 0 && entry.mtime >= 0) {
+            m_entries.insert(handle, entry);
+        }
+    }
+}
+
+/**!
+ * @brief Flag the entries of content files that may have changed.
+ *
+ * A file is considered unchanged if its size and modification time match
+ * the entry. The entries of other files are kept, but flagged as stale, so
+ * that the file is only counted again if the hash of its text has changed.
+ * Entries of missing files are dropped. This only needs a stat per file,
+ * and is safe to run on a worker thread before the index is handed over.
+ *
+ * @param contentDir The project content folder.
+ * @return int       The number of entries flagged or dropped.
+ */
+int ContentIndex::validate(const QDir &contentDir) {
+    int changed = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        QFileInfo info(contentDir.filePath(Storage::contentFileName(it.key())));
+        if (!info.exists()) {
+            it = m_entries.erase(it);
+            changed++;
+            continue;
+        }
+        if (info.size() != it.value().size || info.lastModified().toMSecsSinceEpoch() != it.value().mtime) {
+            it.value().stale = true;
+            changed++;
+        }
+        ++it;
+    }
+    return changed;
+}
+
+// Getters
+// =======
+
+const ContentIndex::Entry *ContentIndex::entry(const QUuid &handle) const {
+    auto it = m_entries.constFind(handle);
+    return it == m_entries.constEnd() ? nullptr : &it.value();
+}
+
+// Static Methods
+// ==============
+
+/**!
+ * @brief Compute the XXH64 hash of a block of data.
+ *
+ * @param data     The data to hash.
+ * @param seed     The hash seed.
+ * @return quint64 The hash value.
+ */
+quint64 ContentIndex::contentHash(QByteArrayView data, quint64 seed) {
+    const uchar *p = reinterpret_cast<const uchar*>(data.data());
+    const uchar *end = p + data.size();
+    quint64 hash;
+
+    if (data.size() >= 32) {
+        quint64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        quint64 v2 = seed + XXH_PRIME64_2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - XXH_PRIME64_1;
+        const uchar *limit = end - 32;
+        do {
+            v1 = xxhRound(v1, qFromLittleEndian<quint64>(p));
+            v2 = xxhRound(v2, qFromLittleEndian<quint64>(p + 8));
+            v3 = xxhRound(v3, qFromLittleEndian<quint64>(p + 16));
+            v4 = xxhRound(v4, qFromLittleEndian<quint64>(p + 24));
+            p += 32;
+        } while (p <= limit);
+        hash = xxhRotate(v1, 1) + xxhRotate(v2, 7) + xxhRotate(v3, 12) + xxhRotate(v4, 18);
+        hash = xxhMerge(hash, v1);
+        hash = xxhMerge(hash, v2);
+        hash = xxhMerge(hash, v3);
+        hash = xxhMerge(hash, v4);
+    } else {
+        hash = seed + XXH_PRIME64_5;
+    }
+    hash += static_cast<quint64>(data.size());
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= xxhRound(0, qFromLittleEndian<quint64>(p));
+        hash = xxhRotate(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<quint64>(qFromLittleEndian<quint32>(p)) * XXH_PRIME64_1;
+        hash = xxhRotate(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= static_cast<quint64>(*p) * XXH_PRIME64_5;
+        hash = xxhRotate(hash, 11) * XXH_PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+} // namespace Collett
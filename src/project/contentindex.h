@@ -0,0 +1,71 @@
+/*
+** Collett – Content Index Class
+** =============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_CONTENT_INDEX_H
+#define COLLETT_CONTENT_INDEX_H
+
+#include "collett.h"
+
+#include <QByteArrayView>
+#include <QDir>
+#include <QHash>
+#include <QJsonObject>
+#include <QUuid>
+
+namespace Collett {
+
+class ContentIndex
+{
+public:
+    struct Entry {
+        qint64     size;
+        qint64     mtime;
+        quint64    hash;
+        NodeCounts counts;
+        bool       stale = false;
+    };
+
+    ContentIndex() {};
+    ~ContentIndex() {};
+
+    // Methods
+    void pack(QJsonObject &data) const;
+    void unpack(const QJsonObject &data);
+    int  validate(const QDir &contentDir);
+    void update(const QUuid &handle, const Entry &entry) {m_entries.insert(handle, entry);};
+    void remove(const QUuid &handle) {m_entries.remove(handle);};
+    void clear() {m_entries.clear();};
+
+    // Getters
+    qsizetype size() const {return m_entries.size();};
+    bool contains(const QUuid &handle) const {return m_entries.contains(handle);};
+    const Entry *entry(const QUuid &handle) const;
+
+    // Static Methods
+    static quint64 contentHash(QByteArrayView data, quint64 seed=0);
+
+private:
+    QHash<QUuid, Entry> m_entries;
+
+};
+} // namespace Collett
+
+#endif // COLLETT_CONTENT_INDEX_H
@@ -0,0 +1,401 @@
+/*
+** Collett – Document Class
+** ========================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "contentindex.h"
+#include "counting.h"
+#include "docfile.h"
+#include "document.h"
+#include "piecetable.h"
+#include "storage.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace Collett {
+
+// Constructor/Destructor
+// ======================
+
+Document::Document(const QUuid &handle, QObject *parent) : QObject(parent), m_handle(handle) {
+}
+
+Document::~Document() {
+    qDebug() << "Destructor: Document" << m_handle;
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Read the document text from the project content folder.
+ *
+ * A missing file is not an error, it just means the document is empty. Any
+ * autosave journal left behind is replayed on top of the file, and the
+ * document is then marked as modified. A damaged tail of the journal is cut
+ * off, so that later records are appended right after the last good one.
+ * The text is counted once here, and the counts are then kept up to date by
+ * the editor.
+ *
+ * @param store     The project storage.
+ * @return bool     True if the document was read.
+ */
+bool Document::load(Storage *store) {
+    if (!store) return false;
+
+    QString path = store->contentPath(m_handle);
+    QString text;
+    DocFile file(path);
+    if (QFile::exists(path) && !file.read(text)) {
+        m_lastError = file.lastError();
+        return false;
+    }
+    m_baseSize = file.fileSize();
+    m_baseHash = file.checksum();
+    m_content.setText(text);
+    m_dirty.clear();
+    m_journalSize = 0;
+    m_modified = this->replayJournal(store->journalPath(m_handle)) > 0;
+    if (m_modified) {
+        m_counts = Counting::countText(m_content.text());
+        qInfo() << "Restored autosaved changes to:" << m_handle;
+    } else {
+        m_counts = Counting::countText(text);
+    }
+    return true;
+}
+
+/**!
+ * @brief Write the document text to the project content folder.
+ *
+ * The text is written straight from the pieces of the content, so it is
+ * never built as a single string. The autosave journal is no longer needed
+ * once the file is written, so it is removed.
+ *
+ * @param store     The project storage.
+ * @return bool     True if the document was written.
+ */
+bool Document::save(Storage *store) {
+    if (!store) return false;
+
+    DocFile file(store->contentPath(m_handle));
+    file.setMeta("handle"_L1, m_handle.toString(QUuid::WithoutBraces));
+    file.setMeta("updated"_L1, QDateTime::currentDateTime().toString(Qt::ISODate));
+    if (!file.write(m_content.chunks())) {
+        m_lastError = file.lastError();
+        return false;
+    }
+    m_baseSize = file.fileSize();
+    m_baseHash = file.checksum();
+    QFile::remove(store->journalPath(m_handle));
+    m_dirty.clear();
+    m_journalSize = 0;
+    m_modified = false;
+    return true;
+}
+
+/**!
+ * @brief Replace a range of the text.
+ *
+ * The edit is recorded for undo. Consecutive typing is merged into a single
+ * edit, up to the end of a word.
+ *
+ * @param pos    The start of the range.
+ * @param length The number of characters to remove.
+ * @param text   The text to insert in their place.
+ */
+void Document::replace(qsizetype pos, qsizetype length, const QString &text) {
+    if (length == 0 && text.isEmpty()) return;
+
+    Edit *last = m_undo.isEmpty() ? nullptr : &m_undo.last();
+    if (m_merge && last && length == 0 && last->removed.isEmpty() && !text.contains(u'\n')
+            && last->pos + last->inserted.size() == pos && !last->inserted.back().isSpace()) {
+        last->inserted.append(text);
+    } else {
+        m_undo.append({pos, m_content.text(pos, length), text});
+        if (m_undo.size() > DOCUMENT_UNDO_LIMIT) m_undo.removeFirst();
+    }
+    m_redo.clear();
+    m_merge = length == 0;
+
+    qsizetype first = m_content.lineAt(pos);
+    qsizetype end = m_content.lineAt(pos + length);
+    m_content.remove(pos, length);
+    m_content.insert(pos, text);
+    this->markLines(first, end + 1, m_content.lineAt(pos + text.size()) + 1);
+    m_modified = true;
+}
+
+/**!
+ * @brief Undo the last edit.
+ *
+ * @return qsizetype The position after the restored text, or -1 if there was
+ *                   nothing to undo.
+ */
+qsizetype Document::undo() {
+    if (m_undo.isEmpty()) return -1;
+    Edit edit = m_undo.takeLast();
+    this->applyEdit(edit.pos, edit.inserted.size(), edit.removed);
+    m_redo.append(edit);
+    m_merge = false;
+    return edit.pos + edit.removed.size();
+}
+
+/**!
+ * @brief Redo the last undone edit.
+ *
+ * @return qsizetype The position after the inserted text, or -1 if there was
+ *                   nothing to redo.
+ */
+qsizetype Document::redo() {
+    if (m_redo.isEmpty()) return -1;
+    Edit edit = m_redo.takeLast();
+    this->applyEdit(edit.pos, edit.removed.size(), edit.inserted);
+    m_undo.append(edit);
+    m_merge = false;
+    return edit.pos + edit.inserted.size();
+}
+
+/**!
+ * @brief Take the journal records of the lines changed since the last ones.
+ *
+ * A new journal starts with a line "## size checksum" naming the content file
+ * the records apply to, so that a journal left behind by a save that did
+ * not finish is not replayed on the saved file.
+ *
+ * There is one record per block of changed lines. A record is a header line
+ * "@@ first removed count size hash" followed by size bytes of UTF-8 text
+ * holding the count new lines that replace the removed lines from the first
+ * line. The records are in order, so the first line of each is the same in
+ * the current text and in the text the earlier records have been applied
+ * to. The hash lets a record cut short by a crash be detected when it is
+ * replayed.
+ *
+ * @return QByteArray The records, or an empty array if nothing changed.
+ */
+QByteArray Document::takeJournalRecords() {
+    if (m_dirty.isEmpty()) return QByteArray();
+
+    QByteArray records;
+    if (m_journalSize == 0) records = this->journalHeader();
+    for (const DirtyRange &range : std::as_const(m_dirty)) {
+        qsizetype count = range.end - range.first;
+        qsizetype removed = count - range.delta;
+        QByteArray payload = m_content.lines(range.first, count).toUtf8();
+        records.append(QStringLiteral("@@ %1 %2 %3 %4 %5\n")
+            .arg(range.first).arg(removed).arg(count).arg(payload.size())
+            .arg(ContentIndex::contentHash(payload), 16, 16, QChar(u'0')).toUtf8());
+        records.append(payload);
+        records.append('\n');
+    }
+
+    m_dirty.clear();
+    m_journalSize += records.size();
+    return records;
+}
+
+// Getters
+// =======
+
+/**!
+ * @brief Estimate the memory used by the document.
+ *
+ * The undo and redo history is included, since an edit holds both the
+ * removed and the inserted text, and large edits can add up to more than
+ * the text itself.
+ */
+qsizetype Document::memoryUsage() const {
+    qsizetype total = m_content.memoryUsage();
+    for (const QList<Edit> *history : {&m_undo, &m_redo}) {
+        total += history->capacity() * sizeof(Edit);
+        for (const Edit &edit : *history) {
+            total += (edit.removed.capacity() + edit.inserted.capacity()) * sizeof(QChar);
+        }
+    }
+    return total;
+}
+
+// Static Functions
+// ================
+
+/**!
+ * @brief Append records to a journal file.
+ *
+ * This is safe to call from a worker thread.
+ *
+ * @param path    The path of the journal file.
+ * @param records The records to append.
+ * @param restart Replace any existing journal, as the records start a new one.
+ * @return bool   True if the records were written.
+ */
+bool Document::appendJournal(const QString &path, const QByteArray &records, bool restart) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | (restart ? QIODevice::Truncate : QIODevice::Append))) {
+        qWarning() << "Could not open file:" << path;
+        return false;
+    }
+    if (file.write(records) != records.size()) {
+        qWarning() << "Could not write file:" << path;
+        return false;
+    }
+    return file.flush();
+}
+
+// Private Methods
+// ===============
+
+/**!
+ * @brief Add an edited line range to the changed lines.
+ *
+ * The edit is merged with the blocks it overlaps or touches, and the blocks
+ * after it are shifted by the number of lines it added. If there are then
+ * too many blocks, the two closest ones are merged, along with the lines
+ * between them.
+ *
+ * @param first     The first line of the edit.
+ * @param endBefore The line after the edit, before it was made.
+ * @param endAfter  The line after the edit, after it was made.
+ */
+void Document::markLines(qsizetype first, qsizetype endBefore, qsizetype endAfter) {
+    qsizetype delta = endAfter - endBefore;
+    DirtyRange edit = {first, endAfter, delta};
+    QList<DirtyRange> ranges;
+    ranges.reserve(m_dirty.size() + 1);
+    bool added = false;
+    for (const DirtyRange &range : std::as_const(m_dirty)) {
+        if (range.end < first) {
+            ranges.append(range);
+        } else if (range.first > endBefore) {
+            if (!added) ranges.append(edit);
+            added = true;
+            ranges.append({range.first + delta, range.end + delta, range.delta});
+        } else {
+            edit.first = qMin(edit.first, range.first);
+            edit.end = qMax(edit.end, range.end + delta);
+            edit.delta += range.delta;
+        }
+    }
+    if (!added) ranges.append(edit);
+
+    if (ranges.size() > DOCUMENT_DIRTY_RANGES) {
+        qsizetype best = 0;
+        for (qsizetype i = 1; i < ranges.size() - 1; ++i) {
+            if (ranges.at(i + 1).first - ranges.at(i).end < ranges.at(best + 1).first - ranges.at(best).end) {
+                best = i;
+            }
+        }
+        const DirtyRange &next = ranges.at(best + 1);
+        ranges[best] = {ranges.at(best).first, next.end, ranges.at(best).delta + next.delta};
+        ranges.removeAt(best + 1);
+    }
+    m_dirty = ranges;
+}
+
+/**!
+ * @brief Apply an undo or redo edit.
+ *
+ * Unlike edits from the editor, these arrive without counts, so the touched
+ * lines are recounted here.
+ */
+void Document::applyEdit(qsizetype pos, qsizetype length, const QString &text) {
+    qsizetype first = m_content.lineAt(pos);
+    qsizetype end = m_content.lineAt(pos + length);
+    m_counts -= Counting::countText(m_content.lines(first, end - first + 1));
+    m_content.remove(pos, length);
+    m_content.insert(pos, text);
+    qsizetype newEnd = m_content.lineAt(pos + text.size());
+    m_counts += Counting::countText(m_content.lines(first, newEnd - first + 1));
+    this->markLines(first, end + 1, newEnd + 1);
+    m_modified = true;
+}
+
+/**!
+ * @brief Replay a journal file on top of the content.
+ *
+ * A journal that was not made for the current content file is discarded.
+ * Replaying stops at the first record that is incomplete or does not fit
+ * the text. The journal is truncated there, or removed if no record could
+ * be applied, and the journal size is set to what is left.
+ *
+ * @param path The path of the journal file.
+ * @return int The number of records applied.
+ */
+int Document::replayJournal(const QString &path) {
+    QFile file(path);
+    if (!file.exists() || !file.open(QIODevice::ReadWrite)) return 0;
+    QByteArray data = file.readAll();
+
+    QByteArray header = this->journalHeader();
+    if (!data.startsWith(header)) {
+        qWarning() << "Discarding journal made for another version of the file:" << path;
+        file.remove();
+        return 0;
+    }
+
+    int applied = 0;
+    qsizetype pos = header.size();
+    while (pos < data.size()) {
+        qsizetype end = data.indexOf('\n', pos);
+        if (end < 0) break;
+        QList<QByteArray> fields = data.mid(pos, end - pos).split(' ');
+        if (fields.size() != 6 || fields.at(0) != "@@") break;
+
+        qsizetype first = fields.at(1).toLongLong();
+        qsizetype removed = fields.at(2).toLongLong();
+        qsizetype count = fields.at(3).toLongLong();
+        qsizetype size = fields.at(4).toLongLong();
+        quint64 hash = fields.at(5).toULongLong(nullptr, 16);
+        if (first < 0 || removed < 1 || size < 0 || end + 1 + size > data.size()) break;
+        if (first + removed > m_content.lineCount()) break;
+
+        QByteArrayView payload = QByteArrayView(data).sliced(end + 1, size);
+        if (ContentIndex::contentHash(payload) != hash || payload.count('\n') + 1 != count) break;
+
+        qsizetype start = m_content.lineStart(first);
+        m_content.remove(start, m_content.lineEnd(first + removed - 1) - start);
+        m_content.insert(start, QString::fromUtf8(payload));
+        pos = end + size + 2;
+        applied++;
+    }
+
+    if (applied == 0) {
+        file.remove();
+    } else if (pos < data.size()) {
+        qWarning() << "Discarding damaged journal records in:" << path;
+        file.resize(pos);
+    }
+    m_journalSize = applied > 0 ? pos : 0;
+    return applied;
+}
+
+/**!
+ * @brief The first line of a journal, naming the content file it applies to.
+ */
+QByteArray Document::journalHeader() const {
+    return "## " + QByteArray::number(m_baseSize) + " " + m_baseHash.toHex() + "\n";
+}
+
+} // namespace Collett
@@ -0,0 +1,132 @@
+/*
+** Collett – Document Class
+** ========================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_DOCUMENT_H
+#define COLLETT_DOCUMENT_H
+
+#include "collett.h"
+#include "piecetable.h"
+#include "storage.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QUuid>
+
+#define DOCUMENT_JOURNAL_LIMIT 1048576
+#define DOCUMENT_UNDO_LIMIT 1000
+#define DOCUMENT_DIRTY_RANGES 16
+
+namespace Collett {
+
+class Document : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The editor position in the document, kept while the document is not
+    // shown so that it can be restored when it is opened again
+    struct ViewState {
+        qsizetype cursor = 0;
+        qsizetype topLine = 0;
+        int       topOffset = 0;
+    };
+
+    explicit Document(const QUuid &handle, QObject *parent = nullptr);
+    ~Document();
+
+    // Methods
+    bool load(Storage *store);
+    bool save(Storage *store);
+    void replace(qsizetype pos, qsizetype length, const QString &text);
+    void addCounts(const NodeCounts &delta) {m_counts += delta;};
+    QByteArray takeJournalRecords();
+    void setViewState(const ViewState &state) {m_viewState = state;};
+    qsizetype undo();
+    qsizetype redo();
+
+    // Getters
+    QUuid handle() const {return m_handle;};
+    bool isModified() const {return m_modified;};
+    bool canUndo() const {return !m_undo.isEmpty();};
+    bool canRedo() const {return !m_redo.isEmpty();};
+    bool hasJournalChanges() const {return !m_dirty.isEmpty();};
+    qint64 journalSize() const {return m_journalSize;};
+    NodeCounts counts() const {return m_counts;};
+    const PieceTable &content() const {return m_content;};
+    ViewState viewState() const {return m_viewState;};
+    qsizetype memoryUsage() const;
+
+    // Error Handling
+    bool hasError() const {return !m_lastError.isEmpty();};
+    QString lastError() const {return m_lastError;};
+
+    // Static Functions
+    static bool appendJournal(const QString &path, const QByteArray &records, bool restart);
+
+private:
+    // An edit in document coordinates, so that it stays valid when the
+    // editor window moves
+    struct Edit {
+        qsizetype pos;
+        QString   removed;
+        QString   inserted;
+    };
+
+    // A block of changed lines. Lines first up to end of the current text
+    // replace the same lines of the text at the last journal record, with
+    // delta more lines than before.
+    struct DirtyRange {
+        qsizetype first;
+        qsizetype end;
+        qsizetype delta;
+    };
+
+    QUuid      m_handle;
+    PieceTable m_content;
+    NodeCounts m_counts = {0, 0, 0};
+    bool       m_modified = false;
+    ViewState  m_viewState;
+    QString    m_lastError = "";
+
+    // The lines changed since the last journal record, in order and with no
+    // overlap, and at most DOCUMENT_DIRTY_RANGES of them
+    QList<DirtyRange> m_dirty;
+    qint64            m_journalSize = 0;
+
+    // The size and checksum of the content file the journal applies to
+    qint64     m_baseSize = 0;
+    QByteArray m_baseHash;
+
+    // Undo History
+    QList<Edit> m_undo;
+    QList<Edit> m_redo;
+    bool        m_merge = false;
+
+    void markLines(qsizetype first, qsizetype endBefore, qsizetype endAfter);
+    void applyEdit(qsizetype pos, qsizetype length, const QString &text);
+    int  replayJournal(const QString &path);
+    QByteArray journalHeader() const;
+};
+} // namespace Collett
+
+#endif // COLLETT_DOCUMENT_H
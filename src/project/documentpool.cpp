@@ -0,0 +1,167 @@
+/*
+** Collett – Document Pool Class
+** =============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "document.h"
+#include "documentpool.h"
+#include "storage.h"
+
+#include <QHash>
+#include <QList>
+#include <QUuid>
+
+namespace Collett {
+
+// Constructor/Destructor
+// ======================
+
+DocumentPool::DocumentPool(QObject *parent) : QObject(parent) {
+}
+
+DocumentPool::~DocumentPool() {
+    qDebug() << "Destructor: DocumentPool";
+}
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Get a document, loading it if it is not in the pool.
+ *
+ * The document becomes the most recently used one, and documents that no
+ * longer fit in the memory budget are evicted. A document that was evicted
+ * earlier gets back the view state it had then.
+ *
+ * @param handle     The handle of the document.
+ * @param store      The project storage.
+ * @return Document* The document, or a nullptr if it could not be loaded.
+ */
+Document *DocumentPool::acquire(const QUuid &handle, Storage *store) {
+    Document *document = m_documents.value(handle, nullptr);
+    if (document) {
+        m_order.removeOne(document);
+        m_order.append(document);
+        return document;
+    }
+
+    document = new Document(handle, this);
+    if (!document->load(store)) {
+        qWarning() << document->lastError();
+        delete document;
+        return nullptr;
+    }
+    auto state = m_viewStates.constFind(handle);
+    if (state != m_viewStates.constEnd()) {
+        document->setViewState(state.value());
+        m_viewStates.erase(state);
+    }
+    m_documents.insert(handle, document);
+    m_order.append(document);
+    this->evict(store);
+    return document;
+}
+
+/**!
+ * @brief Save all modified documents in the pool.
+ *
+ * @param store The project storage.
+ * @return bool True if all documents were saved.
+ */
+bool DocumentPool::saveAll(Storage *store) {
+    bool success = true;
+    for (Document *document : std::as_const(m_order)) {
+        if (document->isModified() && !document->save(store)) {
+            qWarning() << document->lastError();
+            success = false;
+        }
+    }
+    return success;
+}
+
+/**!
+ * @brief Save and drop all documents in the pool.
+ *
+ * @param store The project storage, or a nullptr to drop without saving.
+ */
+void DocumentPool::clear(Storage *store) {
+    if (store) this->saveAll(store);
+    qDeleteAll(m_order);
+    m_order.clear();
+    m_documents.clear();
+    m_viewStates.clear();
+}
+
+/**!
+ * @brief Drop a document from the pool without saving it.
+ *
+ * This is used when the node of the document has been deleted, so that no
+ * file or journal is written for it later.
+ *
+ * @param handle The handle of the document.
+ */
+void DocumentPool::remove(const QUuid &handle) {
+    m_viewStates.remove(handle);
+    Document *document = m_documents.take(handle);
+    if (!document) return;
+    m_order.removeOne(document);
+    delete document;
+}
+
+// Getters
+// =======
+
+qint64 DocumentPool::memoryUsage() const {
+    qint64 total = 0;
+    for (const Document *document : m_order) {
+        total += document->memoryUsage();
+    }
+    return total;
+}
+
+// Private Methods
+// ===============
+
+/**!
+ * @brief Drop the least recently used documents until the pool fits.
+ *
+ * The most recently used document is always kept, even if it is larger than
+ * the budget on its own. A modified document is saved before it is dropped,
+ * and is kept if the save fails. The view state of a dropped document is
+ * kept in the pool.
+ */
+void DocumentPool::evict(Storage *store) {
+    qint64 total = this->memoryUsage();
+    qsizetype i = 0;
+    while (total > m_budget && i < m_order.size() - 1) {
+        Document *document = m_order.at(i);
+        if (document->isModified() && !document->save(store)) {
+            qWarning() << document->lastError();
+            i++;
+            continue;
+        }
+        total -= document->memoryUsage();
+        m_viewStates.insert(document->handle(), document->viewState());
+        m_documents.remove(document->handle());
+        m_order.removeAt(i);
+        delete document;
+    }
+}
+
+} // namespace Collett
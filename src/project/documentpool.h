@@ -0,0 +1,71 @@
+/*
+** Collett – Document Pool Class
+** =============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_DOCUMENT_POOL_H
+#define COLLETT_DOCUMENT_POOL_H
+
+#include "collett.h"
+#include "document.h"
+#include "storage.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QUuid>
+
+namespace Collett {
+
+class DocumentPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentPool(QObject *parent = nullptr);
+    ~DocumentPool();
+
+    // Methods
+    Document *acquire(const QUuid &handle, Storage *store);
+    bool saveAll(Storage *store);
+    void clear(Storage *store);
+    void remove(const QUuid &handle);
+
+    // Setters
+    void setBudget(qint64 bytes) {m_budget = bytes;};
+
+    // Getters
+    qsizetype count() const {return m_order.size();};
+    qint64 memoryUsage() const;
+
+private:
+    // Documents are kept in order of use, with the most recently used last
+    QHash<QUuid, Document*> m_documents;
+    QList<Document*>        m_order;
+    qint64                  m_budget = 0;
+
+    // The view states of evicted documents, restored when they are loaded
+    QHash<QUuid, Document::ViewState> m_viewStates;
+
+    void evict(Storage *store);
+};
+} // namespace Collett
+
+#endif // COLLETT_DOCUMENT_POOL_H
@@ -0,0 +1,231 @@
+/*
+** Collett – Project Name Index Class
+** ==================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "nameindex.h"
+#include "node.h"
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+#define NAME_BONUS_MATCH 1
+#define NAME_BONUS_BOUNDARY 8
+#define NAME_BONUS_CONSECUTIVE 5
+#define NAME_BONUS_PREFIX 10
+
+namespace Collett {
+
+// Public Methods
+// ==============
+
+/**!
+ * @brief Build the index from a list of nodes.
+ *
+ * The names are folded to lower case without accents, and stored back to
+ * back in a single buffer together with a character mask for each name.
+ *
+ * @param nodes The nodes to index, in display order.
+ */
+void NameIndex::build(const QList<Node*> &nodes) {
+
+    this->clear();
+    m_offsets.reserve(nodes.size() + 1);
+    m_masks.reserve(nodes.size());
+    m_handles.reserve(nodes.size());
+
+    m_offsets.append(0);
+    for (const Node *node : nodes) {
+        QByteArray folded = NameIndex::foldName(node->name());
+        m_chars.append(folded);
+        m_offsets.append(m_chars.size());
+        m_masks.append(NameIndex::charMask(folded.constData(), folded.size()));
+        m_handles.append(node->handle());
+    }
+}
+
+void NameIndex::clear() {
+    m_chars.clear();
+    m_offsets.clear();
+    m_masks.clear();
+    m_handles.clear();
+}
+
+/**!
+ * @brief Find the names that fuzzy match a query.
+ *
+ * A name matches if all characters of the query appear in it in the same
+ * order. The names are first filtered on their character masks, which only
+ * needs a bitwise test per name, and only the remaining names are scored.
+ *
+ * @param query  The search text.
+ * @param limit  The maximum number of results.
+ * @return QList<Match> The matches, best match first.
+ */
+QList<NameIndex::Match> NameIndex::search(const QString &query, qsizetype limit) const {
+
+    QList<Match> result;
+    QByteArray folded = NameIndex::foldName(query);
+    folded.replace(" ", "");
+    if (folded.isEmpty() || limit <= 0) {
+        return result;
+    }
+
+    const char *qData = folded.constData();
+    qsizetype qLen = folded.size();
+    quint64 qMask = NameIndex::charMask(qData, qLen);
+
+    const quint64 *masks = m_masks.constData();
+    const quint32 *offsets = m_offsets.constData();
+    const char *chars = m_chars.constData();
+    qsizetype count = m_masks.size();
+
+    QList<qsizetype> candidates;
+    for (qsizetype i = 0; i < count; ++i) {
+        if ((masks[i] & qMask) == qMask) candidates.append(i);
+    }
+
+    QList<std::pair<qint32, qsizetype>> scored;
+    scored.reserve(candidates.size());
+    for (qsizetype i : std::as_const(candidates)) {
+        qint32 score = NameIndex::scoreName(chars + offsets[i], offsets[i+1] - offsets[i], qData, qLen);
+        if (score > 0) scored.append({score, i});
+    }
+
+    // Higher scores first, and ties in index order
+    auto better = [](const std::pair<qint32, qsizetype> &a, const std::pair<qint32, qsizetype> &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    qsizetype n = qMin(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end(), better);
+
+    result.reserve(n);
+    for (qsizetype i = 0; i < n; ++i) {
+        result.append({m_handles.at(scored.at(i).second), scored.at(i).first});
+    }
+    return result;
+}
+
+// Static Methods
+// ==============
+
+/**!
+ * @brief Fold a name for matching.
+ *
+ * The name is converted to lower case and accents are removed, so that for
+ * instance "Émile" is matched by "emile". The result is UTF-8.
+ */
+QByteArray NameIndex::foldName(const QString &name) {
+
+    bool ascii = true;
+    for (QChar c : name) {
+        if (c.unicode() >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+    if (ascii) {
+        QByteArray folded = name.toLatin1();
+        for (char &c : folded) {
+            if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        }
+        return folded;
+    }
+
+    QString decomposed = name.normalized(QString::NormalizationForm_KD);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (QChar c : decomposed) {
+        if (!c.isMark()) folded.append(c.toLower());
+    }
+    return folded.toUtf8();
+}
+
+// Private Functions
+// =================
+
+/**!
+ * @brief Compute a mask of which letters and digits occur in a string.
+ *
+ * Bits 0-25 are the letters a-z, bits 26-35 are the digits, and bit 63 is
+ * set for any non-ASCII byte. Other characters are not tracked.
+ */
+quint64 NameIndex::charMask(const char *data, qsizetype length) {
+    quint64 mask = 0;
+    for (qsizetype i = 0; i < length; ++i) {
+        uchar c = static_cast<uchar>(data[i]);
+        if (c >= 'a' && c <= 'z') {
+            mask |= Q_UINT64_C(1) << (c - 'a');
+        } else if (c >= '0' && c <= '9') {
+            mask |= Q_UINT64_C(1) << (26 + c - '0');
+        } else if (c >= 0x80) {
+            mask |= Q_UINT64_C(1) << 63;
+        }
+    }
+    return mask;
+}
+
+/**!
+ * @brief Score a name against a query.
+ *
+ * The query characters are matched left to right. Matches at the start of
+ * a word and runs of consecutive matches score higher, and shorter names are
+ * preferred over longer ones with the same matches.
+ *
+ * @return qint32 The score, or 0 if the name does not match.
+ */
+qint32 NameIndex::scoreName(const char *name, qsizetype nameLen, const char *query, qsizetype queryLen) {
+
+    if (queryLen > nameLen) return 0;
+
+    qint32 score = 0;
+    qsizetype q = 0;
+    qsizetype last = -2;
+    for (qsizetype i = 0; i < nameLen && q < queryLen; ++i) {
+        if (name[i] != query[q]) continue;
+
+        qint32 bonus = NAME_BONUS_MATCH;
+        if (i == 0) {
+            bonus += NAME_BONUS_PREFIX;
+        }
+        uchar prev = i > 0 ? static_cast<uchar>(name[i-1]) : ' ';
+        bool prevAlnum = (prev >= 'a' && prev <= 'z') || (prev >= '0' && prev <= '9') || prev >= 0x80;
+        if (!prevAlnum) {
+            bonus += NAME_BONUS_BOUNDARY;
+        }
+        if (last == i - 1) {
+            bonus += NAME_BONUS_CONSECUTIVE;
+        }
+        score += bonus;
+        last = i;
+        ++q;
+    }
+    if (q < queryLen) {
+        return 0;
+    }
+
+    // Scale up so the length penalty never outweighs a single match bonus
+    return 64*score - qMin<qint32>(nameLen - queryLen, 63);
+}
+
+} // namespace Collett
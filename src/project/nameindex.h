@@ -0,0 +1,71 @@
+/*
+** Collett – Project Name Index Class
+** ==================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_NAME_INDEX_H
+#define COLLETT_NAME_INDEX_H
+
+#include "collett.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+namespace Collett {
+
+class Node;
+class NameIndex
+{
+public:
+    struct Match {
+        QUuid  handle;
+        qint32 score;
+    };
+
+    NameIndex() {};
+    ~NameIndex() {};
+
+    // Methods
+    void build(const QList<Node*> &nodes);
+    void clear();
+    QList<Match> search(const QString &query, qsizetype limit) const;
+
+    // Getters
+    qsizetype size() const {return m_handles.size();};
+
+    // Static Methods
+    static QByteArray foldName(const QString &name);
+
+private:
+    // The index is stored as flat arrays so that the filter and scoring loops
+    // run over contiguous memory
+    QByteArray     m_chars;
+    QList<quint32> m_offsets;
+    QList<quint64> m_masks;
+    QList<QUuid>   m_handles;
+
+    // Static Functions
+    static quint64 charMask(const char *data, qsizetype length);
+    static qint32  scoreName(const char *name, qsizetype nameLen, const char *query, qsizetype queryLen);
+};
+} // namespace Collett
+
+#endif // COLLETT_NAME_INDEX_H
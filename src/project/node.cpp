@@ -43,8 +43,6 @@ Node::Node(Tree *tree, ItemType itemType, QUuid handle, QString name) :
 {
     m_class = ItemClass::NovelClass;
     m_level = ItemLevel::PageLevel;
-    m_icon = QIcon();
-    m_activeIcon = QIcon();
     if (itemType == ItemType::RootType) {
         m_flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDropEnabled;
     } else if (itemType == ItemType::FileType || itemType == ItemType::FolderType) {
@@ -53,34 +51,102 @@ Node::Node(Tree *tree, ItemType itemType, QUuid handle, QString name) :
 }
 
 Node::~Node() {
-    qDebug() << "Destructor: Node" << m_name;
     qDeleteAll(m_children);  // Parent is tracked in m_parent, so we delete explicitly
 }
 
+// Getters
+// =======
+
+/**!
+ * @brief Return the summed counts of the node and all its descendants.
+ *
+ * The sum is cached, and the cache is cleared for the node and its
+ * ancestors when counts change or children are added or removed.
+ */
+Node::Counts Node::subTreeCounts() const {
+    if (m_subDirty) {
+        m_subCounts = m_counts;
+        for (const Node *child : m_children) {
+            Counts counts = child->subTreeCounts();
+            m_subCounts.characters += counts.characters;
+            m_subCounts.words += counts.words;
+            m_subCounts.paragraphs += counts.paragraphs;
+        }
+        m_subDirty = false;
+    }
+    return m_subCounts;
+}
+
+/**!
+ * @brief Return a record of the node and its location in the tree.
+ */
+NodeRecord Node::record() const {
+    return {
+        m_handle, m_parent ? m_parent->handle() : QUuid(), this->row(),
+        m_type, m_class, m_level, m_name, m_active, m_counts, m_expanded
+    };
+}
+
 // Setters
 // =======
 
+/**!
+ * @brief Set the name of the node.
+ *
+ * Like the other setters that change what the views show, this reports the
+ * change to the tree, which passes it on to the model for batching.
+ */
+void Node::setName(QString name) {
+    name = name.simplified();
+    if (name != m_name) {
+        m_name = name;
+        m_tree->nodeRenamed(this);
+    }
+}
+
 void Node::setActive(bool state) {
-    Theme *theme = Theme::instance();
-    if (m_type == ItemType::InvisibleRoot) {
-        m_icon = QIcon();
-    } else {
+    if (m_type != ItemType::InvisibleRoot) {
+        bool changed = state != m_active;
         m_active = state;
         if (m_type == ItemType::FileType) {
-            if (m_active) {
-                m_accActive = tr("Active");
-                m_activeIcon = theme->icons()->getIcon("checked", ThemeColor::Green, theme->baseIconSize());
-            } else {
-                m_accActive = tr("Inactive");
-                m_activeIcon = theme->icons()->getIcon("unchecked", ThemeColor::Red, theme->baseIconSize());
-            }
+            m_accActive = m_active ? tr("Active") : tr("Inactive");
         } else {
             m_accActive = "";
-            m_activeIcon = theme->icons()->getIcon("noncheckable", ThemeColor::FadedColor, theme->baseIconSize());
+        }
+        if (changed) {
+            m_tree->updateNodeBits(this);
+            m_tree->nodeChanged(this);
         }
     }
 }
 
+/**!
+ * @brief Set the item level of a file node.
+ *
+ * This does not check that the level is allowed for the class of the node,
+ * and is meant for restoring a previously valid level.
+ */
+void Node::setItemLevel(ItemLevel itemLevel) {
+    if (m_type == ItemType::FileType && itemLevel != m_level) {
+        m_level = itemLevel;
+        m_tree->updateNodeBits(this);
+        m_tree->nodeChanged(this);
+    }
+}
+
+void Node::setCounts(Counts counts) {
+    if (counts.characters == m_counts.characters && counts.words == m_counts.words
+        && counts.paragraphs == m_counts.paragraphs) return;
+
+    m_counts = counts;
+    this->invalidateSubTree();
+
+    // The sub tree totals of the ancestors have changed as well
+    for (Node *node = this; node && node->m_type != ItemType::InvisibleRoot; node = node->m_parent) {
+        m_tree->nodeChanged(node);
+    }
+}
+
 // Checkers
 // ========
 
@@ -180,125 +246,6 @@ void Node::pack(QJsonObject &data) {
     }
 }
 
-void Node::unpack(const QJsonObject &data, int &skipped, int &errors) {
-
-    if (data.isEmpty()) {
-        qWarning() << "Received a project node with no data";
-        skipped++;
-        errors++;
-        return;
-    }
-
-    bool error = false;
-
-    QString   name      = "";
-    QUuid     handle    = QUuid();
-    ItemType  itemType  = ItemType::FileType;
-    ItemClass itemClass = ItemClass::NovelClass;
-    ItemLevel itemLevel = ItemLevel::PageLevel;
-    Counts    counts    = {0, 0, 0};
-    bool      expanded  = false;
-    bool      active    = false;
-
-    // Name (Optional)
-    if (data.contains("u:name"_L1)) {
-        name = data["u:name"_L1].toString();
-    }
-    if (name.isEmpty()) {
-        name = tr("Unnamed");
-    }
-
-    // Handle (Required)
-    if (data.contains("m:handle"_L1)) {
-        handle = QUuid(data["m:handle"_L1].toString());
-    }
-    if (handle.isNull()) {
-        qWarning() << "Received a project node with invalid handle";
-        error &= true;
-        errors++;
-    }
-
-    // Item Type (Required)
-    if (!Node::typeFromString(JsonUtils::getJsonString(data, "m:type"_L1, "Error"), itemType)) {
-        qWarning() << "Received a project node with invalid type";
-        error &= true;
-        errors++;
-    }
-
-    // Other Values
-    if (data.contains("u:active"_L1)) {
-        active = data["u:active"_L1].toBool();
-    }
-
-    // Meta Values
-    if (data.contains("m:words"_L1)) {
-        counts.words = data["m:words"_L1].toInt();
-    }
-    if (data.contains("m:characters"_L1)) {
-        counts.characters = data["m:characters"_L1].toInt();
-    }
-    if (data.contains("m:expanded"_L1)) {
-        expanded = data["m:expanded"_L1].toBool();
-    }
-
-    // Error Handling
-    if (error) {
-        qWarning() << "Skipping project node with name " << name << "due to errors";
-        skipped++;
-        return;
-    }
-
-    Node *node = nullptr;
-    switch (itemType) {
-        case ItemType::RootType:
-            if (!Node::classFromString(JsonUtils::getJsonString(data, "m:class"_L1, "Error"), itemClass)) {
-                qWarning() << "Received a project root node with invalid class";
-                errors++;
-            }
-            node = this->createRoot(handle, name, itemClass);
-            this->addChild(node);
-            break;
-        case ItemType::FolderType:
-            node = this->createFolder(handle, name);
-            this->addChild(node);
-            break;
-        case ItemType::FileType:
-            if (!Node::levelFromString(JsonUtils::getJsonString(data, "m:level"_L1, "Error"), itemLevel)) {
-                qWarning() << "Received a project node with invalid level";
-                errors++;
-            }
-            node = this->createFile(handle, name, itemLevel);
-            this->addChild(node);
-            break;
-        default:
-            break;
-    }
-
-    if (node) {
-        qDebug() << "Added node with handle" << handle.toString(QUuid::WithoutBraces);
-    } else {
-        qWarning() << "Failed to add node with handle" << handle.toString(QUuid::WithoutBraces);
-        skipped++;
-        return;
-    }
-
-    node->setCounts(counts);
-    node->setExpanded(expanded);
-    node->setActive(active);
-
-    if (data.contains("x:items"_L1)) {
-        if (data["x:items"_L1].isArray()) {
-            for (const QJsonValue &value : data["x:items"_L1].toArray()) {
-                if (value.isObject()) {
-                    node->unpack(value.toObject(), skipped, errors);
-                } else {
-                    qWarning() << "Item: Child item is not a JSON object";
-                }
-            }
-        }
-    }
-}
-
 // Model Access
 // ============
 
@@ -319,39 +266,87 @@ Node *Node::child(int row) {
 }
 
 QVariant Node::data(int column, int role) const {
-    switch (column) {
-        case 0:
-            switch (role) {
-                case Qt::DisplayRole:
-                case Qt::ToolTipRole:
-                case Qt::AccessibleTextRole:
-                    return QVariant::fromValue(m_name);
-                case Qt::DecorationRole:
-                    return QVariant::fromValue(m_icon);
-            }
-            break;
-        case 1:
-            switch (role) {
-                case Qt::DisplayRole:
-                    return QVariant::fromValue(m_counts.words);
-                case Qt::ToolTipRole:
-                case Qt::AccessibleTextRole:
-                    return QVariant::fromValue(m_accWords.arg(m_counts.words));
-                case Qt::TextAlignmentRole:
-                    return QVariant::fromValue(Qt::AlignRight);
-            }
-            break;
-        case 2:
-            switch (role) {
-                case Qt::DecorationRole:
-                    return QVariant::fromValue(m_activeIcon);
-                case Qt::ToolTipRole:
-                case Qt::AccessibleTextRole:
-                    return QVariant::fromValue(m_accActive);
-            }
-            break;
+    QModelRoleData roleData(role);
+    this->multiData(column, roleData);
+    return roleData.data();
+}
+
+/**!
+ * @brief Fill in the data of several roles for a column in one pass.
+ *
+ * @param column       The model column.
+ * @param roleDataSpan The roles to fill in. Unknown roles are cleared.
+ */
+void Node::multiData(int column, QModelRoleDataSpan roleDataSpan) const {
+    Theme *theme = Theme::instance();
+    bool visible = m_type != ItemType::InvisibleRoot;
+    for (QModelRoleData &roleData : roleDataSpan) {
+        int role = roleData.role();
+        switch (role) {
+            case ProjectRole::ItemLevelRole:
+                roleData.setData(static_cast<int>(m_level));
+                continue;
+            case ProjectRole::ItemActiveRole:
+                roleData.setData(m_active);
+                continue;
+            case ProjectRole::SubTreeWordsRole:
+                roleData.setData(this->subTreeCounts().words);
+                continue;
+            case ProjectRole::SubTreeCharactersRole:
+                roleData.setData(this->subTreeCounts().characters);
+                continue;
+        }
+        switch (column) {
+            case 0:
+                switch (role) {
+                    case Qt::DisplayRole:
+                    case Qt::ToolTipRole:
+                    case Qt::AccessibleTextRole:
+                        roleData.setData(m_name);
+                        continue;
+                    case Qt::DecorationRole:
+                        if (visible) {
+                            roleData.setData(theme->icons()->getProjectIcon(
+                                m_type, m_class, m_level, theme->baseIconSize()
+                            ));
+                            continue;
+                        }
+                        break;
+                }
+                break;
+            case 1:
+                switch (role) {
+                    case Qt::DisplayRole:
+                        roleData.setData(m_counts.words);
+                        continue;
+                    case Qt::ToolTipRole:
+                    case Qt::AccessibleTextRole:
+                        roleData.setData(m_accWords.arg(m_counts.words));
+                        continue;
+                    case Qt::TextAlignmentRole:
+                        roleData.setData(QVariant::fromValue(Qt::AlignRight));
+                        continue;
+                }
+                break;
+            case 2:
+                switch (role) {
+                    case Qt::DecorationRole:
+                        if (visible) {
+                            roleData.setData(theme->icons()->getStateIcon(
+                                m_type == ItemType::FileType, m_active, theme->baseIconSize()
+                            ));
+                            continue;
+                        }
+                        break;
+                    case Qt::ToolTipRole:
+                    case Qt::AccessibleTextRole:
+                        roleData.setData(m_accActive);
+                        continue;
+                }
+                break;
+        }
+        roleData.clearData();
     }
-    return QVariant();
 }
 
 QList<Node*> Node::allChildren() {
@@ -371,19 +366,34 @@ void Node::addChild(Node *child, qsizetype pos) {
     } else {
         m_children.append(child);
     }
-    child->updateIcon();
     child->updateValues();
+    this->invalidateSubTree();
 }
 
 Node *Node::takeChild(qsizetype pos) {
     if (pos >= 0 && pos < m_children.count()) {
         Node *child = m_children.takeAt(pos);
         m_tree->removeNode(child->handle());
+        this->invalidateSubTree();
         return child;
     }
     return nullptr;
 }
 
+/**!
+ * @brief Replace the order of the children.
+ *
+ * The list must hold the same nodes as the current children. This does not
+ * notify the model, which is the caller's responsibility.
+ */
+bool Node::reorderChildren(const QList<Node*> &children) {
+    if (children.size() != m_children.size()) {
+        return false;
+    }
+    m_children = children;
+    return true;
+}
+
 bool Node::canAddRoot() {
     if (m_type == ItemType::InvisibleRoot) {
         return true;
@@ -447,29 +457,19 @@ Node *Node::createFile(QUuid handle, QString name, ItemLevel itemLevel) {
     return node;
 }
 
-void Node::updateIcon() {
-    Theme *theme = Theme::instance();
-    if (m_type == ItemType::InvisibleRoot) {
-        m_icon = QIcon();
-    } else {
-        m_icon = theme->icons()->getProjectIcon(m_type, m_class, m_level, theme->baseIconSize());
-    }
-}
-
 void Node::updateValues() {
     if (m_parent && m_parent->itemType() != ItemType::InvisibleRoot) {
         m_class = m_parent->m_class;
         if (this->isFileType()) {
             if (this->isDocument() && !this->isDocumentAllowed()) {
                 m_level = ItemLevel::NoteLevel;
-                this->updateIcon();
             }
             if (this->isNote() && !this->isNoteAllowed()) {
                 m_level = ItemLevel::PageLevel;
-                this->updateIcon();
             }
         }
     }
+    m_tree->updateNodeBits(this);
 }
 
 // Static Methods
@@ -555,6 +555,117 @@ bool Node::levelFromString(QString value, ItemLevel &itemLevel) {
     return false;
 }
 
+/**!
+ * @brief Read node records from the JSON data of a node.
+ *
+ * This only reads the data and does not touch any node or tree, so it is safe
+ * to call from a worker thread. The records are listed in pre-order, which is
+ * the order they must be created in.
+ *
+ * @param data      The JSON data of the node.
+ * @param parent    The handle of the parent node.
+ * @param row       The row of the node under its parent, or -1 to append.
+ * @param recursive Whether to also read the child nodes.
+ * @param records   The list to append the records to.
+ * @param skipped   Counter for skipped nodes.
+ * @param errors    Counter for errors.
+ * @return bool     True if the node itself was read.
+ */
+bool Node::readRecords(
+    const QJsonObject &data, const QUuid &parent, qsizetype row, bool recursive,
+    QList<NodeRecord> &records, int &skipped, int &errors
+) {
+    if (data.isEmpty()) {
+        qWarning() << "Received a project node with no data";
+        skipped++;
+        errors++;
+        return false;
+    }
+
+    bool error = false;
+
+    NodeRecord record = {
+        QUuid(), parent, row, ItemType::FileType, ItemClass::NovelClass,
+        ItemLevel::PageLevel, "", false
+    };
+
+    // Name (Optional)
+    if (data.contains("u:name"_L1)) {
+        record.name = data["u:name"_L1].toString();
+    }
+    if (record.name.isEmpty()) {
+        record.name = tr("Unnamed");
+    }
+
+    // Handle (Required)
+    if (data.contains("m:handle"_L1)) {
+        record.handle = QUuid(data["m:handle"_L1].toString());
+    }
+    if (record.handle.isNull()) {
+        qWarning() << "Received a project node with invalid handle";
+        error = true;
+        errors++;
+    }
+
+    // Item Type (Required)
+    if (!Node::typeFromString(JsonUtils::getJsonString(data, "m:type"_L1, "Error"), record.itemType)) {
+        qWarning() << "Received a project node with invalid type";
+        error = true;
+        errors++;
+    }
+
+    // Other Values
+    if (data.contains("u:active"_L1)) {
+        record.active = data["u:active"_L1].toBool();
+    }
+
+    // Meta Values
+    if (data.contains("m:words"_L1)) {
+        record.counts.words = data["m:words"_L1].toInt();
+    }
+    if (data.contains("m:characters"_L1)) {
+        record.counts.characters = data["m:characters"_L1].toInt();
+    }
+    if (data.contains("m:expanded"_L1)) {
+        record.expanded = data["m:expanded"_L1].toBool();
+    }
+
+    // Class and Level
+    if (record.itemType == ItemType::RootType) {
+        if (!Node::classFromString(JsonUtils::getJsonString(data, "m:class"_L1, "Error"), record.itemClass)) {
+            qWarning() << "Received a project root node with invalid class";
+            errors++;
+        }
+    } else if (record.itemType == ItemType::FileType) {
+        if (!Node::levelFromString(JsonUtils::getJsonString(data, "m:level"_L1, "Error"), record.itemLevel)) {
+            qWarning() << "Received a project node with invalid level";
+            errors++;
+        }
+    }
+
+    // Error Handling
+    if (error) {
+        qWarning() << "Skipping project node with name " << record.name << "due to errors";
+        skipped++;
+        return false;
+    }
+
+    records.append(record);
+
+    if (recursive && data.contains("x:items"_L1)) {
+        if (data["x:items"_L1].isArray()) {
+            for (const QJsonValue &value : data["x:items"_L1].toArray()) {
+                if (value.isObject()) {
+                    Node::readRecords(value.toObject(), record.handle, -1, true, records, skipped, errors);
+                } else {
+                    qWarning() << "Item: Child item is not a JSON object";
+                }
+            }
+        }
+    }
+    return true;
+}
+
 // Private Methods
 // ===============
 
@@ -565,4 +676,11 @@ void Node::recursiveAppendChildren(QList<Node*> &children) {
     }
 }
 
+void Node::invalidateSubTree() {
+    // If a node is dirty, all its ancestors are as well, so we can stop there
+    for (Node *node = this; node && !node->m_subDirty; node = node->m_parent) {
+        node->m_subDirty = true;
+    }
+}
+
 } // namespace Collett
@@ -24,7 +24,7 @@
 
 #include "collett.h"
 
-#include <QIcon>
+#include <QAbstractItemModel>
 #include <QJsonObject>
 #include <QList>
 #include <QString>
@@ -33,24 +33,48 @@
 
 namespace Collett {
 
+// Node Records
+// Compact, handle based descriptions of nodes and node moves, used where a
+// change to the tree must be recorded or replayed without holding pointers.
+struct NodeRecord {
+    QUuid      handle;
+    QUuid      parent;
+    qsizetype  row;
+    ItemType   itemType;
+    ItemClass  itemClass;
+    ItemLevel  itemLevel;
+    QString    name;
+    bool       active;
+    NodeCounts counts = {0, 0, 0};
+    bool       expanded = false;
+};
+
+struct NodeMove {
+    QUuid     handle;
+    QUuid     fromParent;
+    qsizetype fromRow;
+    QUuid     toParent;
+    qsizetype toRow;
+};
+
+struct NodeLevel {
+    QUuid     handle;
+    ItemLevel itemLevel;
+};
+
 class Tree;
 class Node : public QObject
 {
     Q_OBJECT
 
-    struct Counts {
-        qint32 characters;
-        qint32 words;
-        qint32 paragraphs;
-    };
-
 public:
+    using Counts = NodeCounts;
+
     Node(Tree *tree, ItemType itemType, QUuid handle, QString name);
     ~Node();
 
     // Methods
     void pack(QJsonObject &data);
-    void unpack(const QJsonObject &data, int &skipped, int &errors);
 
     // Getters
     ItemType  itemType() const {return m_type;};
@@ -58,14 +82,20 @@ public:
     ItemLevel itemLevel() const {return m_level;};
     QUuid     handle() const {return m_handle;};
     QString   name() const {return m_name;};
-    Counts    counts() {return m_counts;};
+    Counts    counts() const {return m_counts;};
+    Counts    subTreeCounts() const;
+    bool      isActive() const {return m_active;};
     bool      isExpanded() {return m_expanded;};
+    qsizetype slot() const {return m_slot;};
+    NodeRecord record() const;
 
     // Setters
-    void setName(QString name) {m_name = name.simplified();};
-    void setCounts(Counts counts) {m_counts = counts;};
+    void setName(QString name);
+    void setCounts(Counts counts);
     void setExpanded(bool state) {m_expanded = state;};
     void setActive(bool state);
+    void setItemLevel(ItemLevel itemLevel);
+    void setSlot(qsizetype slot) {m_slot = slot;};
 
     // Checkers
     bool isRootType() {return m_type == ItemType::RootType;};
@@ -80,6 +110,7 @@ public:
     int row() const;
     int childCount() const {return m_children.count();};
     QVariant data(int column, int role) const;
+    void multiData(int column, QModelRoleDataSpan roleDataSpan) const;
     Qt::ItemFlags flags() const {return m_flags;};
     Node *child(int row);
     Node *parent() {return m_parent;};
@@ -89,6 +120,7 @@ public:
     // Model Edit
     void  addChild(Node *child, qsizetype pos = -1);
     Node *takeChild(qsizetype pos);
+    bool  reorderChildren(const QList<Node*> &children);
 
     bool canAddRoot();
     bool canAddFolder();
@@ -98,13 +130,16 @@ public:
     Node *createFolder(QUuid handle, QString name);
     Node *createFile(QUuid handle, QString name, ItemLevel itemLevel);
 
-    void updateIcon();
     void updateValues();
 
     // Static Methods
     static bool typeFromString(QString value, ItemType &itemType);
     static bool classFromString(QString value, ItemClass &itemClass);
     static bool levelFromString(QString value, ItemLevel &itemLevel);
+    static bool readRecords(
+        const QJsonObject &data, const QUuid &parent, qsizetype row, bool recursive,
+        QList<NodeRecord> &records, int &skipped, int &errors
+    );
 
 private:
     // Attributes
@@ -117,10 +152,12 @@ private:
     Qt::ItemFlags m_flags = Qt::NoItemFlags;
 
     // Meta
-    QIcon  m_icon;
     Counts m_counts = {0, 0, 0};
     bool   m_expanded = false;
-    QIcon  m_activeIcon;
+
+    // Sub Tree Cache
+    mutable Counts m_subCounts = {0, 0, 0};
+    mutable bool   m_subDirty = true;
 
     // Accessibility
     QString m_accWords = tr("Word Count: %1");
@@ -130,9 +167,11 @@ private:
     Tree         *m_tree;
     Node         *m_parent = nullptr;
     QList<Node*>  m_children;
+    qsizetype     m_slot = -1;
 
     // Methods
     void recursiveAppendChildren(QList<Node*> &children);
+    void invalidateSubTree();
 };
 } // namespace Collett
 
@@ -22,8 +22,19 @@
 #include "project.h"
 #include "storage.h"
 
+#include "counting.h"
+#include "docfile.h"
+#include "node.h"
+#include "tools.h"
+
 #include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
 #include <QJsonObject>
+#include <QtConcurrent>
+
+using namespace Qt::Literals::StringLiterals;
 
 namespace Collett {
 
@@ -31,10 +42,33 @@ namespace Collett {
 // ======================
 
 Project::Project() {
+    m_loader = new QFutureWatcher<ProjectBatch>(this);
+    connect(m_loader, &QFutureWatcher<ProjectBatch>::resultsReadyAt, this, &Project::processBatches);
+    connect(m_loader, &QFutureWatcher<ProjectBatch>::finished, this, &Project::finishLoading);
+    connect(m_loader, &QFutureWatcher<ProjectBatch>::progressValueChanged, this, [this](int value) {
+        emit loadProgress(value, m_loader->progressMaximum());
+    });
+
+    m_counter = new QFutureWatcher<ProjectCount>(this);
+    connect(m_counter, &QFutureWatcher<ProjectCount>::resultsReadyAt, this, &Project::applyCounts);
+    connect(m_counter, &QFutureWatcher<ProjectCount>::finished, this, &Project::finishRecount);
+    connect(m_counter, &QFutureWatcher<ProjectCount>::progressValueChanged, this, [this](int value) {
+        emit recountProgress(value, m_counter->progressMaximum());
+    });
 }
 
 Project::~Project() {
     qDebug() << "Destructor: Project";
+    if (m_loading) {
+        m_loader->disconnect(this);
+        m_loader->cancel();
+        m_loader->waitForFinished();
+    }
+    if (m_counter->isRunning()) {
+        m_counter->disconnect(this);
+        m_counter->cancel();
+        m_counter->waitForFinished();
+    }
 }
 
 // Public Methods
@@ -49,21 +83,17 @@ bool Project::openProject(const QString &path) {
         return false;
     }
 
-    QJsonObject jData, jTree;
-
-    if (!m_store->readProject(jData)) {
-        m_lastError = m_store->lastError();
-        return false;
-    }
     m_data = new ProjectData();
-    m_data->unpack(jData);
-
-    if (!m_store->readStructure(jTree)) {
-        m_lastError = m_store->lastError();
-        return false;
-    }
     m_tree = new Tree(this);
-    m_tree->unpack(jTree);
+    m_tree->setStore(m_store);
+
+    // The project files are parsed on a worker thread, and the tree is
+    // populated as the batches arrive, so the GUI remains responsive
+    m_loading = true;
+    m_loader->setFuture(QtConcurrent::run(
+        &Project::loadProject, m_store->projectFile(), m_store->structureFile(),
+        m_store->contentIndexFile(), m_store->contentDir(), m_tree->model()->invisibleRoot()->handle()
+    ));
 
     m_isValid = true;
 
@@ -72,6 +102,11 @@ bool Project::openProject(const QString &path) {
 
 bool Project::saveProject() {
 
+    if (m_loading) {
+        qWarning() << "Project is still loading, cannot save";
+        return false;
+    }
+
     if (m_store == nullptr || m_data == nullptr) {
         qWarning() << "Project storage not initialised, cannot save";
         return false;
@@ -97,13 +132,295 @@ bool Project::saveProject() {
         return false;
     }
 
+    QJsonObject jIndex;
+    m_contentIndex.pack(jIndex);
+    if (!m_store->writeContentIndex(jIndex)) {
+        m_lastError = m_store->lastError();
+        return false;
+    }
+
     return true;
 }
 
 bool Project::saveProjectAs(const QString &path) {
+    if (m_loading) {
+        qWarning() << "Project is still loading, cannot save";
+        return false;
+    }
     m_store = new Storage(path, false);
+    if (m_tree) m_tree->setStore(m_store);
     m_isValid = true;
     return this->saveProject();
 }
 
+/**!
+ * @brief Recount all file items of the project.
+ *
+ * The content files are read and counted in parallel on the global thread
+ * pool. The counts are applied to the nodes as the results come in. Files
+ * that match their content index entry are not read at all.
+ *
+ * @return bool True if the job was started.
+ */
+bool Project::recountProject() {
+    if (m_loading || !m_tree || !m_store || m_counter->isRunning()) {
+        return false;
+    }
+
+    QList<ProjectCount> items;
+    for (Node *node : m_tree->model()->invisibleRoot()->allChildren()) {
+        if (node->isFileType()) {
+            ProjectCount item;
+            item.handle = node->handle();
+            item.path = m_store->contentPath(item.handle);
+            if (const ContentIndex::Entry *entry = m_contentIndex.entry(item.handle)) {
+                item.entry = *entry;
+                item.indexed = true;
+            }
+            items.append(item);
+        }
+    }
+    qInfo() << "Recounting" << items.size() << "project items";
+    m_recountSkipped = 0;
+    m_counter->setFuture(QtConcurrent::mapped(std::move(items), &Project::countFile));
+    return true;
+}
+
+void Project::cancelRecount() {
+    if (m_counter->isRunning()) m_counter->cancel();
+}
+
+// Private Slots
+// =============
+
+/**!
+ * @brief Apply the batches delivered by the loader.
+ *
+ * The first batch holds the project data, the rest hold node records that
+ * are inserted into the model as a single block per batch.
+ *
+ * @param begin The index of the first batch.
+ * @param end   The index after the last batch.
+ */
+void Project::processBatches(int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        const ProjectBatch batch = m_loader->resultAt(i);
+        if (!batch.error.isEmpty()) {
+            m_lastError = batch.error;
+        } else if (i == 0) {
+            m_data->unpack(batch.data);
+            m_contentIndex = batch.index;
+        } else if (!batch.records.isEmpty()) {
+            m_tree->model()->insertRecords(batch.records);
+        }
+    }
+}
+
+/**!
+ * @brief Wrap up when the loader is done.
+ *
+ * Resetting the future releases the batches held in its result store.
+ */
+void Project::finishLoading() {
+    bool success = m_lastError.isEmpty() && !m_loader->isCanceled();
+    m_loader->setFuture(QFuture<ProjectBatch>());
+    m_loading = false;
+    qInfo() << "Project loaded:" << (success ? "OK" : "Failed");
+    emit loadFinished(success);
+}
+
+/**!
+ * @brief Apply a batch of results from the recount job.
+ *
+ * The model collects the changed nodes and emits them together, so this
+ * does not cause one view update per item.
+ *
+ * @param begin The index of the first result.
+ * @param end   The index after the last result.
+ */
+void Project::applyCounts(int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        const ProjectCount result = m_counter->resultAt(i);
+        if (!result.valid) continue;
+        if (result.indexed) {
+            m_contentIndex.update(result.handle, result.entry);
+        } else {
+            m_contentIndex.remove(result.handle);
+        }
+        if (!result.changed) m_recountSkipped++;
+        Node *node = m_tree->node(result.handle);
+        if (node) node->setCounts(result.entry.counts);
+    }
+}
+
+void Project::finishRecount() {
+    bool completed = !m_counter->isCanceled();
+    m_counter->setFuture(QFuture<ProjectCount>());
+    qInfo() << "Recount project:" << (completed ? "Done" : "Cancelled");
+    qInfo() << "Unchanged items:" << m_recountSkipped;
+    emit recountFinished(completed);
+}
+
+// Static Methods
+// ==============
+
+/**!
+ * @brief Count the content file of a single item.
+ *
+ * This runs on a worker thread. If the size and modification time match the
+ * index entry, and it is not stale, the file is not read. If they don't, but
+ * the hash of the text does, the file is not counted. The header is left out
+ * of the hash, since it changes on every save. A missing file is an empty
+ * item.
+ *
+ * @param item          The item, with its index entry if it has one.
+ * @return ProjectCount The item with an updated index entry.
+ */
+ProjectCount Project::countFile(const ProjectCount &item) {
+    ProjectCount result = item;
+    QFileInfo info(item.path);
+    if (!info.exists()) {
+        result.entry = {0, 0, 0, {0, 0, 0}};
+        result.indexed = false;
+        result.changed = item.indexed;
+        return result;
+    }
+
+    qint64 size = info.size();
+    qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+    if (item.indexed && !item.entry.stale && item.entry.size == size && item.entry.mtime == mtime) {
+        return result;
+    }
+
+    QFile source(item.path);
+    if (!source.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open file:" << item.path;
+        result.valid = false;
+        return result;
+    }
+    QByteArray content = source.readAll();
+    QByteArrayView body = QByteArrayView(content).sliced(DocFile::headerSize(content));
+    quint64 hash = ContentIndex::contentHash(body);
+    if (item.indexed && item.entry.hash == hash) {
+        result.entry.size = content.size();
+        result.entry.mtime = mtime;
+        result.entry.stale = false;
+    } else {
+        result.entry = {content.size(), mtime, hash, Counting::countUtf8(body)};
+        result.changed = true;
+    }
+    result.indexed = true;
+    return result;
+}
+
+/**!
+ * @brief Parse the project files into batches.
+ *
+ * This runs on a worker thread and must not touch any live objects. Each root
+ * node is sent as a separate batch, followed by its child items in batches of
+ * about PROJECT_LOAD_BATCH records, so that the model can be populated in
+ * contiguous blocks.
+ *
+ * @param promise       The promise receiving the batches.
+ * @param projectFile   The path to the project data file.
+ * @param structureFile The path to the project structure file.
+ * @param indexFile     The path to the content index file.
+ * @param contentDir    The project content folder.
+ * @param root          The handle of the invisible root node.
+ */
+void Project::loadProject(
+    QPromise<ProjectBatch> &promise, const QString &projectFile,
+    const QString &structureFile, const QString &indexFile,
+    const QDir &contentDir, const QUuid &root
+) {
+    ProjectBatch first;
+    if (JsonUtils::readJson(projectFile, first.data, true) != JsonUtilsError::NoError) {
+        first.error = tr("Could not read file: %1").arg(projectFile);
+        promise.addResult(first);
+        return;
+    }
+
+    // The content index is optional, and entries for changed files are flagged
+    QJsonObject jIndex;
+    if (JsonUtils::readJson(indexFile, jIndex, false) == JsonUtilsError::NoError) {
+        first.index.unpack(jIndex);
+        int changed = first.index.validate(contentDir);
+        qDebug() << "Content index:" << first.index.size() << "entries," << changed << "changed";
+    }
+    promise.addResult(first);
+
+    QJsonObject jTree;
+    if (JsonUtils::readJson(structureFile, jTree, false) != JsonUtilsError::NoError) {
+        ProjectBatch failed;
+        failed.error = tr("Could not read file: %1").arg(structureFile);
+        promise.addResult(failed);
+        return;
+    }
+    if (!jTree["x:items"_L1].isArray()) {
+        qWarning() << "No root nodes in project";
+        return;
+    }
+
+    QJsonArray jRoots = jTree["x:items"_L1].toArray();
+    int total = 0;
+    for (const QJsonValue &value : jRoots) {
+        total += 1 + value.toObject()["x:items"_L1].toArray().size();
+    }
+    promise.setProgressRange(0, total);
+
+    int progress = 0;
+    int skipped = 0;
+    int errors = 0;
+    qsizetype rootRow = 0;
+    for (const QJsonValue &value : jRoots) {
+        if (promise.isCanceled()) return;
+
+        if (!value.isObject()) {
+            qWarning() << "Project root node is not a JSON object";
+            promise.setProgressValue(++progress);
+            continue;
+        }
+
+        QJsonObject jRoot = value.toObject();
+        QJsonArray jItems = jRoot["x:items"_L1].toArray();
+
+        ProjectBatch batch;
+        if (!Node::readRecords(jRoot, root, rootRow, false, batch.records, skipped, errors)) {
+            progress += 1 + jItems.size();
+            promise.setProgressValue(progress);
+            continue;
+        }
+        promise.addResult(batch);
+        promise.setProgressValue(++progress);
+
+        QUuid handle = batch.records.first().handle;
+        batch.records.clear();
+        rootRow++;
+
+        qsizetype row = 0;
+        for (const QJsonValue &item : jItems) {
+            if (!item.isObject()) {
+                qWarning() << "Item: Child item is not a JSON object";
+            } else if (Node::readRecords(item.toObject(), handle, row, true, batch.records, skipped, errors)) {
+                row++;
+            }
+            progress++;
+            if (batch.records.size() >= PROJECT_LOAD_BATCH) {
+                if (promise.isCanceled()) return;
+                promise.addResult(batch);
+                promise.setProgressValue(progress);
+                batch.records.clear();
+            }
+        }
+        if (!batch.records.isEmpty()) {
+            promise.addResult(batch);
+        }
+        promise.setProgressValue(progress);
+    }
+
+    if (skipped > 0 || errors > 0) {
+        qWarning() << "Project tree loaded with" << skipped << "skipped nodes and" << errors << "errors";
+    }
+}
+
 } // namespace Collett
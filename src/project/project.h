@@ -23,14 +23,43 @@
 #define COLLETT_PROJECT_H
 
 #include "collett.h"
+#include "contentindex.h"
 #include "projectdata.h"
 #include "storage.h"
 #include "tree.h"
 
+#include <QFutureWatcher>
 #include <QJsonObject>
+#include <QList>
+#include <QPromise>
+#include <QUuid>
+
+#define PROJECT_LOAD_BATCH 2000
 
 namespace Collett {
 
+// Project Load Batch
+// A part of the project parsed by the loader. The first batch holds the
+// project data, the following ones hold node records for the tree.
+struct ProjectBatch {
+    QJsonObject       data;
+    ContentIndex      index;
+    QList<NodeRecord> records;
+    QString           error;
+};
+
+// Project Count Item
+// A project item for the recount job. The index entry is passed in, and the
+// updated entry is passed back out.
+struct ProjectCount {
+    QUuid               handle;
+    QString             path;
+    ContentIndex::Entry entry;
+    bool                indexed = false;
+    bool                changed = false;
+    bool                valid = true;
+};
+
 class Project : public QObject
 {
     Q_OBJECT
@@ -43,21 +72,51 @@ public:
     bool openProject(const QString &path);
     bool saveProject();
     bool saveProjectAs(const QString &path);
+    bool recountProject();
+    void cancelRecount();
 
     // Getters
     bool isValid() const {return m_isValid;};
+    bool isLoading() const {return m_loading;};
+    bool isRecounting() const {return m_counter->isRunning();};
     Storage *store() {return m_store;};
     ProjectData *data() {return m_data;};
     Tree *tree() {return m_tree;};
+    ContentIndex &contentIndex() {return m_contentIndex;};
 
     // Error Handling
     bool hasError() const {return !m_lastError.isEmpty();};
     QString lastError() const {return m_lastError;};
 
+signals:
+    void loadProgress(int value, int total);
+    void loadFinished(bool success);
+    void recountProgress(int value, int total);
+    void recountFinished(bool completed);
+
+private slots:
+    void processBatches(int begin, int end);
+    void finishLoading();
+    void applyCounts(int begin, int end);
+    void finishRecount();
+
 private:
     bool     m_isValid = false;
+    bool     m_loading = false;
     QString  m_lastError = "";
 
+    QFutureWatcher<ProjectBatch> *m_loader = nullptr;
+    QFutureWatcher<ProjectCount> *m_counter = nullptr;
+    int          m_recountSkipped = 0;
+    ContentIndex m_contentIndex;
+
+    static void loadProject(
+        QPromise<ProjectBatch> &promise, const QString &projectFile,
+        const QString &structureFile, const QString &indexFile,
+        const QDir &contentDir, const QUuid &root
+    );
+    static ProjectCount countFile(const ProjectCount &item);
+
     Storage     *m_store = nullptr;
     ProjectData *m_data = nullptr;
     Tree        *m_tree = nullptr;
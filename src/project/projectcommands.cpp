@@ -0,0 +1,236 @@
+/*
+** Collett – Project Undo Commands
+** ===============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "contentindex.h"
+#include "docfile.h"
+#include "projectcommands.h"
+#include "projectmodel.h"
+#include "storage.h"
+#include "tree.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QUndoCommand>
+#include <QUuid>
+
+namespace Collett {
+
+/**!
+ * @brief Hash the text of a content file, leaving out the header.
+ *
+ * @param path  The path of the content file.
+ * @param hash  Receives the hash.
+ * @return bool True if the file could be read.
+ */
+static bool hashContent(const QString &path, quint64 &hash) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QByteArray content = file.readAll();
+    hash = ContentIndex::contentHash(QByteArrayView(content).sliced(DocFile::headerSize(content)));
+    return true;
+}
+
+// Add Node
+// ========
+
+AddNodeCommand::AddNodeCommand(ProjectModel *model, const NodeRecord &record, QUndoCommand *parent) :
+    ProjectCommand(parent), m_model(model), m_record(record)
+{
+    this->setText(QCoreApplication::translate("ProjectCommands", "Add %1").arg(record.name));
+}
+
+void AddNodeCommand::undo() {
+    m_model->deleteNode(m_record.handle);
+}
+
+void AddNodeCommand::redo() {
+    m_model->createNode(m_record);
+}
+
+bool AddNodeCommand::touches(const QSet<QUuid> &handles) const {
+    return handles.contains(m_record.handle) || handles.contains(m_record.parent);
+}
+
+// Rename Node
+// ===========
+
+RenameNodeCommand::RenameNodeCommand(
+    ProjectModel *model, const QUuid &handle, const QString &oldName, const QString &newName, QUndoCommand *parent
+) : ProjectCommand(parent), m_model(model), m_handle(handle), m_oldName(oldName), m_newName(newName)
+{
+    this->setText(QCoreApplication::translate("ProjectCommands", "Rename %1").arg(oldName));
+}
+
+bool RenameNodeCommand::mergeWith(const QUndoCommand *other) {
+    const RenameNodeCommand *command = static_cast<const RenameNodeCommand*>(other);
+    if (command->m_handle != m_handle) {
+        return false;
+    }
+    m_newName = command->m_newName;
+    return true;
+}
+
+void RenameNodeCommand::undo() {
+    m_model->setNodeName(m_handle, m_oldName);
+}
+
+void RenameNodeCommand::redo() {
+    m_model->setNodeName(m_handle, m_newName);
+}
+
+bool RenameNodeCommand::touches(const QSet<QUuid> &handles) const {
+    return handles.contains(m_handle);
+}
+
+// Move Nodes
+// ==========
+
+MoveNodesCommand::MoveNodesCommand(
+    ProjectModel *model, const QList<QUuid> &handles, const QUuid &parent, qsizetype pos, QUndoCommand *command
+) : ProjectCommand(command), m_model(model), m_handles(handles), m_parent(parent), m_pos(pos)
+{
+    this->setText(QCoreApplication::translate("ProjectCommands", "Move %n Item(s)", nullptr, handles.size()));
+}
+
+void MoveNodesCommand::undo() {
+    m_model->applyMoves(m_moves, m_levels, true);
+}
+
+void MoveNodesCommand::redo() {
+    if (m_done) {
+        m_model->applyMoves(m_moves, m_levels, false);
+    } else {
+        m_model->moveNodes(m_handles, m_parent, m_pos, m_moves, m_levels);
+        m_handles.clear();
+        m_done = true;
+        if (m_moves.isEmpty()) this->setObsolete(true);
+    }
+}
+
+bool MoveNodesCommand::touches(const QSet<QUuid> &handles) const {
+    if (handles.contains(m_parent)) return true;
+    for (const QUuid &handle : m_handles) {
+        if (handles.contains(handle)) return true;
+    }
+    for (const NodeMove &move : m_moves) {
+        if (handles.contains(move.handle) || handles.contains(move.fromParent) || handles.contains(move.toParent)) return true;
+    }
+    return false;
+}
+
+// Sort Children
+// =============
+
+SortChildrenCommand::SortChildrenCommand(
+    ProjectModel *model, const QUuid &parent, const QList<QUuid> &before, const QList<QUuid> &after, QUndoCommand *command
+) : ProjectCommand(command), m_model(model), m_parent(parent), m_before(before), m_after(after)
+{
+    this->setText(QCoreApplication::translate("ProjectCommands", "Sort %n Item(s)", nullptr, after.size()));
+}
+
+void SortChildrenCommand::undo() {
+    m_model->setChildOrder(m_parent, m_before);
+}
+
+void SortChildrenCommand::redo() {
+    m_model->setChildOrder(m_parent, m_after);
+}
+
+bool SortChildrenCommand::touches(const QSet<QUuid> &handles) const {
+    if (handles.contains(m_parent)) return true;
+    for (const QUuid &handle : m_before) {
+        if (handles.contains(handle)) return true;
+    }
+    return false;
+}
+
+// Clone Nodes
+// ===========
+
+CloneNodesCommand::CloneNodesCommand(
+    ProjectModel *model, const QList<NodeRecord> &records, const QList<QPair<QUuid, QUuid>> &copies, QUndoCommand *parent
+) : ProjectCommand(parent), m_model(model), m_records(records), m_copies(copies)
+{
+    this->setText(QCoreApplication::translate("ProjectCommands", "Copy %n Item(s)", nullptr, records.size()));
+}
+
+void CloneNodesCommand::undo() {
+    m_model->removeRecords(m_records);
+    m_hashes.clear();
+    Storage *store = m_model->tree()->store();
+    if (store) {
+        for (const auto &copy : std::as_const(m_copies)) {
+            store->removeContent(copy.second);
+        }
+    }
+}
+
+void CloneNodesCommand::redo() {
+    m_model->insertRecords(m_records);
+    Storage *store = m_model->tree()->store();
+    for (const auto &copy : std::as_const(m_copies)) {
+        if (store && !store->copyContent(copy.first, copy.second)) {
+            qWarning() << "Could not copy content of" << copy.first;
+        }
+        quint64 hash = 0;
+        if (store && hashContent(store->contentPath(copy.second), hash)) {
+            m_hashes.insert(copy.second, hash);
+        }
+    }
+}
+
+bool CloneNodesCommand::touches(const QSet<QUuid> &handles) const {
+    for (const NodeRecord &record : m_records) {
+        if (handles.contains(record.handle) || handles.contains(record.parent)) return true;
+    }
+    for (const auto &copy : m_copies) {
+        if (handles.contains(copy.first)) return true;
+    }
+    return false;
+}
+
+/**!
+ * @brief Check if any of the copies have been edited since they were made.
+ *
+ * Only the files are checked, so any open documents must be saved first.
+ * A journal left for a copy also counts as an edit.
+ */
+bool CloneNodesCommand::isModified() const {
+    Storage *store = m_model->tree()->store();
+    if (!store) return false;
+    for (const auto &copy : std::as_const(m_copies)) {
+        if (QFile::exists(store->journalPath(copy.second))) return true;
+        quint64 hash = 0;
+        bool exists = hashContent(store->contentPath(copy.second), hash);
+        auto it = m_hashes.constFind(copy.second);
+        if (exists != (it != m_hashes.constEnd()) || (exists && hash != it.value())) return true;
+    }
+    return false;
+}
+
+} // namespace Collett
@@ -0,0 +1,176 @@
+/*
+** Collett – Project Undo Commands
+** ===============================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_PROJECT_COMMANDS_H
+#define COLLETT_PROJECT_COMMANDS_H
+
+#include "collett.h"
+#include "node.h"
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QUndoCommand>
+#include <QUuid>
+
+#define UNDO_ID_RENAME 1
+
+namespace Collett {
+
+class ProjectModel;
+
+/**!
+ * @brief The base class of the project tree commands.
+ *
+ * The commands report whether they refer to any of a set of nodes, so that
+ * the history only has to be dropped when one of those nodes is deleted.
+ */
+class ProjectCommand : public QUndoCommand
+{
+public:
+    explicit ProjectCommand(QUndoCommand *parent = nullptr) : QUndoCommand(parent) {};
+
+    virtual bool touches(const QSet<QUuid> &handles) const = 0;
+};
+
+/**!
+ * @brief Add a single node to the project tree.
+ *
+ * The node is described by a record, so it can be removed on undo and created
+ * again with the same handle on redo.
+ */
+class AddNodeCommand : public ProjectCommand
+{
+public:
+    AddNodeCommand(ProjectModel *model, const NodeRecord &record, QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    bool touches(const QSet<QUuid> &handles) const override;
+
+private:
+    ProjectModel *m_model;
+    NodeRecord    m_record;
+};
+
+/**!
+ * @brief Rename a node.
+ *
+ * Consecutive renames of the same node are merged into one command.
+ */
+class RenameNodeCommand : public ProjectCommand
+{
+public:
+    RenameNodeCommand(ProjectModel *model, const QUuid &handle, const QString &oldName, const QString &newName, QUndoCommand *parent = nullptr);
+
+    int id() const override {return UNDO_ID_RENAME;};
+    bool mergeWith(const QUndoCommand *other) override;
+    void undo() override;
+    void redo() override;
+    bool touches(const QSet<QUuid> &handles) const override;
+
+private:
+    ProjectModel *m_model;
+    QUuid         m_handle;
+    QString       m_oldName;
+    QString       m_newName;
+};
+
+/**!
+ * @brief Move a set of nodes to a new parent.
+ *
+ * The first redo performs the move and records each single node move along
+ * with any item levels that had to change. Undo and later redos replay the
+ * records as one layout change of the model.
+ */
+class MoveNodesCommand : public ProjectCommand
+{
+public:
+    MoveNodesCommand(ProjectModel *model, const QList<QUuid> &handles, const QUuid &parent, qsizetype pos, QUndoCommand *command = nullptr);
+
+    void undo() override;
+    void redo() override;
+    bool touches(const QSet<QUuid> &handles) const override;
+
+private:
+    ProjectModel    *m_model;
+    QList<QUuid>     m_handles;
+    QUuid            m_parent;
+    qsizetype        m_pos;
+    bool             m_done = false;
+    QList<NodeMove>  m_moves;
+    QList<NodeLevel> m_levels;
+};
+
+/**!
+ * @brief Reorder the children of a node.
+ *
+ * Both the previous and the new order are recorded, so that the move
+ * commands before it on the stack still find the rows they expect.
+ */
+class SortChildrenCommand : public ProjectCommand
+{
+public:
+    SortChildrenCommand(ProjectModel *model, const QUuid &parent, const QList<QUuid> &before, const QList<QUuid> &after, QUndoCommand *command = nullptr);
+
+    void undo() override;
+    void redo() override;
+    bool touches(const QSet<QUuid> &handles) const override;
+
+private:
+    ProjectModel *m_model;
+    QUuid         m_parent;
+    QList<QUuid>  m_before;
+    QList<QUuid>  m_after;
+};
+
+/**!
+ * @brief Insert clones of a set of nodes and their sub trees.
+ *
+ * The content files of the cloned items are copied on redo and removed on
+ * undo. The records carry the counts of the original items, so the source
+ * documents must be saved before the command is pushed. The hash of the text
+ * of each copy is kept, so that edits made to the copies can be detected
+ * before an undo throws them away.
+ */
+class CloneNodesCommand : public ProjectCommand
+{
+public:
+    CloneNodesCommand(ProjectModel *model, const QList<NodeRecord> &records, const QList<QPair<QUuid, QUuid>> &copies, QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+    bool touches(const QSet<QUuid> &handles) const override;
+
+    bool isModified() const;
+
+private:
+    ProjectModel              *m_model;
+    QList<NodeRecord>          m_records;
+    QList<QPair<QUuid, QUuid>> m_copies;
+    QHash<QUuid, quint64>      m_hashes;
+};
+
+} // namespace Collett
+
+#endif // COLLETT_PROJECT_COMMANDS_H
@@ -0,0 +1,155 @@
+/*
+** Collett – Project Filter Model Class
+** ====================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "node.h"
+#include "projectfilter.h"
+#include "projectmodel.h"
+#include "tree.h"
+
+#include <QBitArray>
+#include <QMetaObject>
+#include <QModelIndex>
+#include <QObject>
+#include <QSortFilterProxyModel>
+
+namespace Collett {
+
+// Constructor/Destructor
+// ======================
+
+ProjectFilterModel::ProjectFilterModel(QObject *parent) : QSortFilterProxyModel(parent) {
+    this->setDynamicSortFilter(false);
+}
+
+ProjectFilterModel::~ProjectFilterModel() {
+    qDebug() << "Destructor: ProjectFilterModel";
+}
+
+// Setters
+// =======
+
+/**!
+ * @brief Set the project tree to filter.
+ *
+ * @param tree The project tree, or nullptr to clear the source model.
+ */
+void ProjectFilterModel::setProjectTree(Tree *tree) {
+
+    for (const QMetaObject::Connection &connection : std::as_const(m_connections)) {
+        this->disconnect(connection);
+    }
+    m_connections.clear();
+
+    m_tree = tree;
+    m_visible.clear();
+    m_revision = 0;
+    m_applied = 0;
+
+    ProjectModel *model = tree ? tree->model() : nullptr;
+    this->setSourceModel(model);
+    if (model) {
+        // Changes to the tree may change which nodes match, so the filter is
+        // refreshed once the current batch of changes has been processed
+        m_connections.append(this->connect(model, &ProjectModel::dataChanged, this, &ProjectFilterModel::queueRefresh));
+        m_connections.append(this->connect(model, &ProjectModel::rowsInserted, this, &ProjectFilterModel::queueRefresh));
+        m_connections.append(this->connect(model, &ProjectModel::rowsRemoved, this, &ProjectFilterModel::queueRefresh));
+        m_connections.append(this->connect(model, &ProjectModel::rowsMoved, this, &ProjectFilterModel::queueRefresh));
+        m_connections.append(this->connect(model, &ProjectModel::layoutChanged, this, &ProjectFilterModel::queueRefresh));
+    }
+}
+
+/**!
+ * @brief Set the node filter.
+ *
+ * The visible nodes are computed once for the whole tree, so the rows are
+ * then accepted or rejected with a single bit test each.
+ *
+ * @param filter The new filter.
+ */
+void ProjectFilterModel::setNodeFilter(const NodeFilter &filter) {
+    m_filter = filter;
+    this->updateVisible();
+    this->invalidateRowsFilter();
+    m_applied = m_revision;
+}
+
+// Filter
+// ======
+
+bool ProjectFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+
+    if (m_filter.isEmpty() || !m_tree) {
+        return true;
+    }
+    if (m_revision != m_tree->bitsRevision()) {
+        this->updateVisible();
+    }
+
+    Node *parent = sourceParent.isValid()
+        ? static_cast<Node*>(sourceParent.internalPointer())
+        : m_tree->model()->invisibleRoot();
+    Node *node = parent ? parent->child(sourceRow) : nullptr;
+    if (!node) {
+        return false;
+    }
+
+    qsizetype slot = node->slot();
+    return slot >= 0 && slot < m_visible.size() && m_visible.testBit(slot);
+}
+
+// Private Methods
+// ===============
+
+void ProjectFilterModel::updateVisible() const {
+    if (m_tree && !m_filter.isEmpty()) {
+        m_visible = m_tree->filterNodes(m_filter);
+        m_revision = m_tree->bitsRevision();
+    } else {
+        m_visible.clear();
+        m_revision = 0;
+    }
+}
+
+// Private Slots
+// =============
+
+void ProjectFilterModel::queueRefresh() {
+    if (!m_refreshQueued && !m_filter.isEmpty()) {
+        m_refreshQueued = true;
+        QMetaObject::invokeMethod(this, &ProjectFilterModel::refreshFilter, Qt::QueuedConnection);
+    }
+}
+
+/**!
+ * @brief Re-apply the filter if any node bits have changed.
+ *
+ * Changes that don't affect the node bits, like new word counts, are skipped.
+ */
+void ProjectFilterModel::refreshFilter() {
+    m_refreshQueued = false;
+    if (m_tree && !m_filter.isEmpty() && m_applied != m_tree->bitsRevision()) {
+        this->updateVisible();
+        this->invalidateRowsFilter();
+        m_applied = m_revision;
+    }
+}
+
+} // namespace Collett
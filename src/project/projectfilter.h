@@ -0,0 +1,79 @@
+/*
+** Collett – Project Filter Model Class
+** ====================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLETT_PROJECT_FILTER_H
+#define COLLETT_PROJECT_FILTER_H
+
+#include "collett.h"
+
+#include <QBitArray>
+#include <QList>
+#include <QMetaObject>
+#include <QModelIndex>
+#include <QObject>
+#include <QPointer>
+#include <QSortFilterProxyModel>
+
+namespace Collett {
+
+class Tree;
+class ProjectFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit ProjectFilterModel(QObject *parent = nullptr);
+    ~ProjectFilterModel();
+
+    // Getters
+    NodeFilter nodeFilter() const {return m_filter;};
+    bool isFiltered() const {return !m_filter.isEmpty();};
+
+    // Setters
+    void setProjectTree(Tree *tree);
+    void setNodeFilter(const NodeFilter &filter);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QPointer<Tree> m_tree;
+    NodeFilter     m_filter;
+    bool           m_refreshQueued = false;
+    quint64        m_applied = 0;
+
+    QList<QMetaObject::Connection> m_connections;
+
+    // Cache
+    mutable QBitArray m_visible;
+    mutable quint64   m_revision = 0;
+
+    // Methods
+    void updateVisible() const;
+
+private slots:
+    void queueRefresh();
+    void refreshFilter();
+
+};
+} // namespace Collett
+
+#endif // COLLETT_PROJECT_FILTER_H
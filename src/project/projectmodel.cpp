@@ -20,19 +20,30 @@
 */
 
 #include "collett.h"
+#include "projectcommands.h"
 #include "projectmodel.h"
+#include "theme.h"
 #include "tree.h"
 
+#include <algorithm>
+#include <functional>
+
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QList>
 #include <QMimeData>
 #include <QModelIndex>
+#include <QPair>
+#include <QPersistentModelIndex>
 #include <QPointer>
 #include <QSet>
 #include <QString>
 #include <QStringList>
+#include <QUndoStack>
 #include <QUuid>
 #include <QVariant>
 
@@ -46,10 +57,26 @@ namespace Collett {
 ProjectModel::ProjectModel(Tree *parent) : QAbstractItemModel(parent), m_tree(parent) {
     m_root = new Node(m_tree, ItemType::InvisibleRoot, QUuid::createUuid(), "InvisibleRoot");
     m_root->setParent(this);
+    m_undoStack = new QUndoStack(this);
+    m_collator.setNumericMode(true);
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    connect(Theme::instance(), &Theme::themeChanged, this, &ProjectModel::refreshDecorations);
 }
 
 ProjectModel::~ProjectModel() {
     qDebug() << "Destructor: ProjectModel";
+
+    // Any view has been detached by now, so the whole node tree can be handed
+    // to a worker rather than freed one node at a time on the GUI thread
+    QList<Node*> nodes = m_root->allChildren();
+    m_root->setParent(nullptr);
+    m_root->moveToThread(nullptr);
+    for (Node *node : std::as_const(nodes)) {
+        node->moveToThread(nullptr);
+    }
+    qDebug() << "Disposing" << nodes.size() << "project nodes";
+    Tree::disposeNodes({m_root}, {});
+    m_root = nullptr;
 }
 
 // Getters
@@ -73,6 +100,19 @@ Node *ProjectModel::rootNode(Node *node) {
     return root;
 }
 
+/**!
+ * @brief Return the Trash root folder, if the project has one.
+ */
+Node *ProjectModel::trashRoot() {
+    for (int i = 0; i < m_root->childCount(); ++i) {
+        Node *node = m_root->child(i);
+        if (node->isRootType() && node->itemClass() == ItemClass::TrashClass) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
 // Public Methods
 // ==============
 
@@ -85,27 +125,6 @@ void ProjectModel::pack(QJsonObject &data) {
     if (m_root) m_root->pack(data);
 }
 
-/**!
- * @brief Unpack nodes from a JSON object.
- *
- * @param data The JSON object to unpack.
- */
-void ProjectModel::unpack(const QJsonObject &data) {
-    int skipped = 0;
-    int errors = 0;
-    if (data.contains("x:items"_L1) && data["x:items"_L1].isArray()) {
-        for (const QJsonValue &value : data["x:items"_L1].toArray()) {
-            if (value.isObject()) {
-                m_root->unpack(value.toObject(), skipped, errors);
-            } else {
-                qWarning() << "Project root node is not a JSON object";
-            }
-        }
-    } else {
-        qWarning() << "No root nodes in project";
-    }
-}
-
 // Model Access
 // ============
 
@@ -170,6 +189,33 @@ QVariant ProjectModel::data(const QModelIndex &index, int role) const {
     return node->data(index.column(), role);
 }
 
+/**!
+ * @brief Fill in several roles of an index in one call.
+ *
+ * Views and the accessibility layer use this to fetch all the roles they
+ * need for an item in one pass over the node data.
+ */
+void ProjectModel::multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const {
+
+    if (!index.isValid()) {
+        for (QModelRoleData &roleData : roleDataSpan) {
+            roleData.clearData();
+        }
+        return;
+    }
+    Node *node = static_cast<Node*>(index.internalPointer());
+    node->multiData(index.column(), roleDataSpan);
+}
+
+QHash<int, QByteArray> ProjectModel::roleNames() const {
+    QHash<int, QByteArray> roles = QAbstractItemModel::roleNames();
+    roles[ProjectRole::ItemLevelRole] = "itemLevel";
+    roles[ProjectRole::ItemActiveRole] = "itemActive";
+    roles[ProjectRole::SubTreeWordsRole] = "subTreeWords";
+    roles[ProjectRole::SubTreeCharactersRole] = "subTreeCharacters";
+    return roles;
+}
+
 Qt::ItemFlags ProjectModel::flags(const QModelIndex &index) const {
 
     if (!index.isValid()) {
@@ -209,6 +255,24 @@ Node *ProjectModel::nodeAtIndex(const QModelIndex &index) {
     return nullptr;
 }
 
+/**!
+ * @brief Return the node with a given handle, including the invisible root.
+ */
+Node *ProjectModel::nodeFromHandle(const QUuid &uuid) {
+    if (uuid == m_root->handle()) return m_root;
+    return m_tree->node(uuid);
+}
+
+/**!
+ * @brief Return the index of a node, or an invalid index for the root.
+ */
+QModelIndex ProjectModel::indexFromNode(Node *node) {
+    if (node && node != m_root) {
+        return createIndex(node->row(), 0, node);
+    }
+    return QModelIndex();
+}
+
 QModelIndex ProjectModel::indexFromHandle(const QUuid &uuid) {
     Node *node = m_tree->node(uuid);
     if (node) {
@@ -273,11 +337,8 @@ Node *ProjectModel::removeChild(const QModelIndex &parent, qsizetype pos) {
 /**!
  * @brief Move a list of indexes to a new parent node.
  *
- * The list of indexes are moved to the new location. If a child and a parent
- * are both selected, only the parent is moved and the child just follows
- * along. The internal meta data of the nodes are updated by the parent node
- * object so that its class and item level info is consistent with its new
- * location in the project.
+ * The list of indexes are moved to the new location. The move is pushed to
+ * the undo stack, and performed by moveNodes().
  *
  * @param indexes A list of indexes to be moved.
  * @param parent  The parent index to move the indexes to.
@@ -286,38 +347,88 @@ Node *ProjectModel::removeChild(const QModelIndex &parent, qsizetype pos) {
 void ProjectModel::multiMove(const QModelIndexList &indexes, const QModelIndex &parent, qsizetype pos) {
     if (!parent.isValid()) return;
 
-    // This is a two pass process. First we only select unique non-root items
-    // for move, then we do a second pass and only move those items that don't
-    // have a parent also scheduled for moving or have already been moved.
-    // Child items are moved with the parent.
-
-    QSet<QUuid> handles;
-    QList<Node*> pruned;
+    QList<QUuid> handles;
     for (QModelIndex index : indexes) {
-        if (index.isValid()) {
-            Node *node = static_cast<Node*>(index.internalPointer());
-            if (node && !node->isRootType() && !handles.contains(node->handle())) {
-                pruned.prepend(node);  // Built in reverse order
-                handles.insert(node->handle());
+        Node *node = this->nodeAtIndex(index);
+        if (node) handles.append(node->handle());
+    }
+    Node *pNode = static_cast<Node*>(parent.internalPointer());
+    if (pNode && !handles.isEmpty()) {
+        m_undoStack->push(new MoveNodesCommand(this, handles, pNode->handle(), pos));
+    }
+}
+
+/**!
+ * @brief Sort the children of a node.
+ *
+ * Names are compared with collation keys for the current locale, which are
+ * cached per node until it is renamed. The sort is stable, so items with the
+ * same name or count keep their order. The sort is pushed to the undo stack
+ * with the previous order, so that earlier moves can still be undone.
+ *
+ * @param parent  The index of the node whose children to sort.
+ * @param sortKey What to sort the children by.
+ * @param order   The sort order.
+ * @return bool   True if the children were sorted.
+ */
+bool ProjectModel::sortChildren(const QModelIndex &parent, SortKey sortKey, Qt::SortOrder order) {
+
+    Node *pNode = parent.isValid() ? static_cast<Node*>(parent.internalPointer()) : m_root;
+    if (!pNode || pNode->childCount() < 2) return false;
+
+    struct SortItem {
+        Node                   *node;
+        const QCollatorSortKey *name;
+        qint32                  words;
+    };
+
+    // Create the missing keys first, as inserting may move the other keys
+    qsizetype count = pNode->childCount();
+    if (sortKey == SortKey::SortByName) {
+        for (qsizetype i = 0; i < count; ++i) {
+            Node *node = pNode->child(i);
+            if (!m_sortKeys.contains(node->handle())) {
+                m_sortKeys.insert(node->handle(), m_collator.sortKey(node->name()));
             }
         }
     }
-    qDebug() << indexes;
 
-    for (Node *mNode : pruned) {
-        Node *pNode = mNode->parent();
-        if (pNode && !handles.contains(pNode->handle())) {
-            QModelIndex index = createIndex(mNode->row(), 0, mNode);
-            Node *tNode = this->removeChild(index.parent(), index.row());
-            qDebug() << tNode;
-            if (tNode) {
-                this->insertChild(tNode, parent, pos);
-                for (Node *cNode : mNode->allChildren()) {
-                    cNode->updateValues();
-                }
-            }
+    QList<SortItem> items;
+    items.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        Node *node = pNode->child(i);
+        SortItem item = {node, nullptr, 0};
+        if (sortKey == SortKey::SortByName) {
+            item.name = &m_sortKeys.constFind(node->handle()).value();
+        } else {
+            item.words = node->subTreeCounts().words;
         }
+        items.append(item);
     }
+
+    bool ascending = order == Qt::AscendingOrder;
+    if (sortKey == SortKey::SortByName) {
+        std::stable_sort(items.begin(), items.end(), [ascending](const SortItem &a, const SortItem &b) {
+            return ascending ? a.name->compare(*b.name) < 0 : b.name->compare(*a.name) < 0;
+        });
+    } else {
+        std::stable_sort(items.begin(), items.end(), [ascending](const SortItem &a, const SortItem &b) {
+            return ascending ? a.words < b.words : b.words < a.words;
+        });
+    }
+
+    QList<QUuid> before;
+    QList<QUuid> after;
+    before.reserve(count);
+    after.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        before.append(pNode->child(i)->handle());
+        after.append(items.at(i).node->handle());
+    }
+    if (before == after) return true;
+
+    m_undoStack->push(new SortChildrenCommand(this, pNode->handle(), before, after));
+    return true;
 }
 
 /**!
@@ -339,10 +450,12 @@ Node *ProjectModel::addRoot(QString name, ItemClass itemClass, const QModelIndex
         if (sNode) pos = sNode->row() + 1;
     }
 
-    Node *child = m_root->createRoot(QUuid::createUuid(), name, itemClass);
-    child->setActive(true);
-    this->insertChild(child, QModelIndex(), pos);
-    return child;
+    NodeRecord record = {
+        QUuid::createUuid(), m_root->handle(), pos,
+        ItemType::RootType, itemClass, ItemLevel::PageLevel, name, true
+    };
+    m_undoStack->push(new AddNodeCommand(this, record));
+    return m_tree->node(record.handle);
 }
 
 /**!
@@ -380,10 +493,12 @@ Node *ProjectModel::addFolder(QString name, const QModelIndex &selected) {
     if (parent.isValid()) {
         Node *nNode = static_cast<Node*>(parent.internalPointer());
         if (nNode) {
-            Node *child = nNode->createFolder(QUuid::createUuid(), name);
-            child->setActive(true);
-            this->insertChild(child, parent, pos);
-            return child;
+            NodeRecord record = {
+                QUuid::createUuid(), nNode->handle(), pos,
+                ItemType::FolderType, nNode->itemClass(), ItemLevel::PageLevel, name, true
+            };
+            m_undoStack->push(new AddNodeCommand(this, record));
+            return m_tree->node(record.handle);
         }
     }
     return nullptr;
@@ -458,15 +573,537 @@ Node *ProjectModel::addFile(QString name, ItemLevel itemLevel, const QModelIndex
     if (parent.isValid()) {
         Node *nNode = static_cast<Node*>(parent.internalPointer());
         if (nNode) {
-            Node *child = nNode->createFile(QUuid::createUuid(), name, itemLevel);
-            child->setActive(true);
-            this->insertChild(child, parent, pos);
-            return child;
+            NodeRecord record = {
+                QUuid::createUuid(), nNode->handle(), pos,
+                ItemType::FileType, nNode->itemClass(), itemLevel, name, true
+            };
+            m_undoStack->push(new AddNodeCommand(this, record));
+            return m_tree->node(record.handle);
         }
     }
     return nullptr;
 }
 
+/**!
+ * @brief Rename a node.
+ *
+ * The rename is pushed to the undo stack if the name changes.
+ *
+ * @param node The node to rename.
+ * @param name The new name.
+ */
+void ProjectModel::renameNode(Node *node, const QString &name) {
+    if (node && name.simplified() != node->name()) {
+        m_undoStack->push(new RenameNodeCommand(this, node->handle(), node->name(), name.simplified()));
+    }
+}
+
+/**!
+ * @brief Clone a set of nodes and their sub trees.
+ *
+ * All clones are given new handles in one pass, and the clones of the top
+ * level nodes are placed next to each other under the new parent. Root nodes
+ * are not cloned. The clone is pushed to the undo stack.
+ *
+ * @param handles The handles of the nodes to clone.
+ * @param parent  The handle of the parent node of the clones.
+ * @param pos     The position under the parent node.
+ * @return bool   True if any nodes were cloned.
+ */
+bool ProjectModel::cloneNodes(const QList<QUuid> &handles, const QUuid &parent, qsizetype pos) {
+
+    Node *pNode = this->nodeFromHandle(parent);
+    if (!pNode || pNode == m_root) return false;
+
+    // Nodes with an ancestor in the list are cloned with the ancestor
+    const QSet<QUuid> selected(handles.begin(), handles.end());
+    QSet<QUuid> added;
+    QList<Node*> pruned;
+    for (const QUuid &handle : handles) {
+        Node *node = m_tree->node(handle);
+        if (!node || node->isRootType() || added.contains(handle)) continue;
+        bool nested = false;
+        for (Node *aNode = node->parent(); aNode && !nested; aNode = aNode->parent()) {
+            nested = selected.contains(aNode->handle());
+        }
+        if (!nested) {
+            pruned.append(node);
+            added.insert(handle);
+        }
+    }
+    if (pruned.isEmpty()) return false;
+
+    // The sub trees are listed in pre-order, so child records can be appended
+    // to their parents as they are created
+    qsizetype row = qMin(qMax(pos, 0), pNode->childCount());
+    QList<NodeRecord> records;
+    QList<QPair<QUuid, QUuid>> copies;
+    for (Node *node : std::as_const(pruned)) {
+        QList<Node*> nodes = node->allChildren();
+        nodes.prepend(node);
+        QHash<QUuid, QUuid> mapped;
+        mapped.insert(node->parent()->handle(), pNode->handle());
+        for (const Node *cNode : std::as_const(nodes)) {
+            NodeRecord record = cNode->record();
+            record.handle = QUuid::createUuid();
+            record.parent = mapped.value(record.parent);
+            record.row = cNode == node ? row++ : -1;
+            mapped.insert(cNode->handle(), record.handle);
+            records.append(record);
+            copies.append({cNode->handle(), record.handle});
+        }
+    }
+
+    m_undoStack->push(new CloneNodesCommand(this, records, copies));
+    return true;
+}
+
+/**!
+ * @brief Move a set of nodes to the Trash root folder.
+ *
+ * The Trash root folder is created if it doesn't exist. The move, and the
+ * creation of the Trash, is recorded as a single undo step.
+ *
+ * @param handles The handles of the nodes to move.
+ * @return bool   True if the move was made.
+ */
+bool ProjectModel::trashNodes(const QList<QUuid> &handles) {
+
+    if (handles.isEmpty()) return false;
+
+    m_undoStack->beginMacro(tr("Move to Trash"));
+    Node *trash = this->trashRoot();
+    if (!trash) {
+        NodeRecord record = {
+            QUuid::createUuid(), m_root->handle(), m_root->childCount(),
+            ItemType::RootType, ItemClass::TrashClass, ItemLevel::PageLevel, tr("Trash"), true
+        };
+        m_undoStack->push(new AddNodeCommand(this, record));
+        trash = m_tree->node(record.handle);
+    }
+    if (trash) {
+        m_undoStack->push(new MoveNodesCommand(this, handles, trash->handle(), trash->childCount()));
+    }
+    m_undoStack->endMacro();
+    return trash != nullptr;
+}
+
+/**!
+ * @brief Permanently delete a set of nodes and their sub trees.
+ *
+ * The nodes are taken out of the model and the tree right away, with one row
+ * removal per block of neighbouring rows. Freeing the nodes and removing
+ * their content files is left to a worker thread. This cannot be undone, and
+ * if any command in the undo history refers to the deleted nodes, the
+ * history is cleared.
+ *
+ * @param handles The handles of the nodes to delete.
+ * @return int    The number of nodes deleted, including descendants.
+ */
+int ProjectModel::destroyNodes(const QList<QUuid> &handles) {
+
+    // Nodes with an ancestor in the list are deleted with the ancestor
+    const QSet<QUuid> selected(handles.begin(), handles.end());
+    QHash<Node*, QList<int>> rows;
+    for (const QUuid &handle : selected) {
+        Node *node = m_tree->node(handle);
+        if (!node || node->isRootType() || !node->parent()) continue;
+        bool nested = false;
+        for (Node *aNode = node->parent(); aNode && !nested; aNode = aNode->parent()) {
+            nested = selected.contains(aNode->handle());
+        }
+        if (!nested) rows[node->parent()].append(node->row());
+    }
+    if (rows.isEmpty()) return 0;
+
+    QList<Node*> detached;
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        Node *pNode = it.key();
+        QList<int> &pRows = it.value();
+        std::sort(pRows.begin(), pRows.end(), std::greater<int>());
+        QModelIndex parent = this->indexFromNode(pNode);
+        qsizetype i = 0;
+        while (i < pRows.size()) {
+            int last = pRows.at(i);
+            int first = last;
+            while (i + 1 < pRows.size() && pRows.at(i + 1) == first - 1) {
+                first = pRows.at(++i);
+            }
+            ++i;
+            emit beginRemoveRows(parent, first, last);
+            for (int row = last; row >= first; --row) {
+                detached.append(pNode->takeChild(row));
+            }
+            emit endRemoveRows();
+        }
+    }
+
+    Storage *store = m_tree->store();
+    QStringList files;
+    QList<QUuid> removed;
+    int count = 0;
+    for (Node *node : std::as_const(detached)) {
+        QList<Node*> nodes = node->allChildren();
+        nodes.prepend(node);
+        for (Node *cNode : std::as_const(nodes)) {
+            m_tree->removeNode(cNode->handle());
+            m_sortKeys.remove(cNode->handle());
+            removed.append(cNode->handle());
+            if (store) {
+                files.append(store->contentPath(cNode->handle()));
+                files.append(store->journalPath(cNode->handle()));
+            }
+            cNode->moveToThread(nullptr);  // So the worker may delete it
+        }
+        count += nodes.size();
+    }
+
+    // Only history that refers to the deleted nodes must be dropped, but the
+    // stack can only be dropped as a whole
+    const QSet<QUuid> deleted(removed.begin(), removed.end());
+    for (int i = 0; i < m_undoStack->count(); ++i) {
+        if (ProjectModel::commandTouches(m_undoStack->command(i), deleted)) {
+            m_undoStack->clear();
+            break;
+        }
+    }
+
+    // The documents must be let go before their files are removed
+    emit nodesRemoved(removed);
+    Tree::disposeNodes(detached, files);
+    return count;
+}
+
+// Command Methods
+// ===============
+
+/**!
+ * @brief Create a node from a record and insert it in the tree.
+ *
+ * @param record The record of the node.
+ * @return Node* The new node, or nullptr if the parent doesn't exist.
+ */
+Node *ProjectModel::createNode(const NodeRecord &record) {
+
+    Node *pNode = this->nodeFromHandle(record.parent);
+    if (!pNode) {
+        qWarning() << "Cannot create node, parent not found";
+        return nullptr;
+    }
+
+    Node *node = nullptr;
+    switch (record.itemType) {
+        case ItemType::RootType:
+            if (pNode->canAddRoot()) node = pNode->createRoot(record.handle, record.name, record.itemClass);
+            break;
+        case ItemType::FolderType:
+            if (pNode->canAddFolder()) node = pNode->createFolder(record.handle, record.name);
+            break;
+        case ItemType::FileType:
+            if (pNode->canAddFile(record.itemLevel)) node = pNode->createFile(record.handle, record.name, record.itemLevel);
+            break;
+        default:
+            break;
+    }
+    if (node) {
+        node->setActive(record.active);
+        this->insertChild(node, this->indexFromNode(pNode), record.row);
+    }
+    return node;
+}
+
+/**!
+ * @brief Remove a node from the tree and delete it.
+ *
+ * @param handle The handle of the node.
+ * @return bool  True if the node was deleted.
+ */
+bool ProjectModel::deleteNode(const QUuid &handle) {
+    Node *node = m_tree->node(handle);
+    if (node && node->parent()) {
+        Node *child = this->removeChild(this->indexFromNode(node->parent()), node->row());
+        if (child) {
+            this->releaseNode(child);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**!
+ * @brief Set the name of the node with a given handle.
+ */
+void ProjectModel::setNodeName(const QUuid &handle, const QString &name) {
+    Node *node = m_tree->node(handle);
+    if (node) node->setName(name);
+}
+
+/**!
+ * @brief Put the children of a node in a given order.
+ *
+ * The views are updated with a single layout change.
+ *
+ * @param parent The handle of the parent node.
+ * @param order  The handles of all its children, in the new order.
+ */
+void ProjectModel::setChildOrder(const QUuid &parent, const QList<QUuid> &order) {
+    Node *pNode = m_tree->node(parent);
+    if (!pNode || pNode->childCount() != order.size()) return;
+
+    qsizetype count = order.size();
+    QList<Node*> sorted;
+    sorted.reserve(count);
+    for (const QUuid &handle : order) {
+        Node *node = m_tree->node(handle);
+        if (!node || node->parent() != pNode) return;
+        sorted.append(node);
+    }
+
+    QModelIndex index = this->indexFromNode(pNode);
+    QList<QPersistentModelIndex> parents = {QPersistentModelIndex(index)};
+    emit layoutAboutToBeChanged(parents, QAbstractItemModel::VerticalSortHint);
+
+    // Only persistent indexes of the sorted children change
+    QModelIndexList from;
+    QModelIndexList to;
+    for (const QModelIndex &pIndex : this->persistentIndexList()) {
+        Node *node = static_cast<Node*>(pIndex.internalPointer());
+        if (node && node->parent() == pNode) {
+            from.append(pIndex);
+        }
+    }
+
+    pNode->reorderChildren(sorted);
+
+    QHash<const Node*, int> rows;
+    if (!from.isEmpty()) {
+        rows.reserve(count);
+        for (qsizetype i = 0; i < count; ++i) {
+            rows.insert(sorted.at(i), i);
+        }
+    }
+    to.reserve(from.size());
+    for (const QModelIndex &pIndex : std::as_const(from)) {
+        Node *node = static_cast<Node*>(pIndex.internalPointer());
+        to.append(createIndex(rows.value(node), pIndex.column(), node));
+    }
+    this->changePersistentIndexList(from, to);
+
+    emit layoutChanged(parents, QAbstractItemModel::VerticalSortHint);
+}
+
+/**!
+ * @brief Move a list of nodes to a new parent node.
+ *
+ * If a child and a parent are both in the list, only the parent is moved and
+ * the child just follows along. The class and item level of the moved nodes
+ * are updated to fit their new location. All moves are done in a single
+ * layout change of the model.
+ *
+ * @param handles The handles of the nodes to move.
+ * @param parent  The handle of the new parent node.
+ * @param pos     The position under the parent to move the nodes to.
+ * @param moves   The single node moves that were made.
+ * @param levels  The previous item levels of nodes whose level changed.
+ */
+void ProjectModel::moveNodes(
+    const QList<QUuid> &handles, const QUuid &parent, qsizetype pos, QList<NodeMove> &moves, QList<NodeLevel> &levels
+) {
+    Node *tNode = this->nodeFromHandle(parent);
+    if (!tNode || tNode == m_root) return;
+
+    // This is a two pass process. First we only select unique non-root items
+    // for move, then we do a second pass and only move those items that don't
+    // have a parent also scheduled for moving. Child items are moved with the
+    // parent.
+
+    QSet<QUuid> selected;
+    QList<Node*> pruned;
+    for (const QUuid &handle : handles) {
+        Node *node = m_tree->node(handle);
+        if (node && !node->isRootType() && !selected.contains(handle)) {
+            pruned.prepend(node);  // Built in reverse order
+            selected.insert(handle);
+        }
+    }
+
+    QModelIndexList persistent = this->beginLayoutMove();
+    for (Node *mNode : std::as_const(pruned)) {
+        Node *pNode = mNode->parent();
+        if (pNode && !selected.contains(pNode->handle())) {
+            NodeMove move = {mNode->handle(), pNode->handle(), mNode->row(), tNode->handle(), 0};
+            move.toRow = this->moveNode(mNode, tNode, pos, &levels);
+            moves.append(move);
+        }
+    }
+    this->endLayoutMove(persistent);
+}
+
+/**!
+ * @brief Replay a list of recorded moves, or revert them.
+ *
+ * @param moves  The recorded single node moves.
+ * @param levels The item levels to restore when reverting.
+ * @param revert If true, the moves are reverted in reverse order.
+ */
+void ProjectModel::applyMoves(const QList<NodeMove> &moves, const QList<NodeLevel> &levels, bool revert) {
+
+    if (moves.isEmpty()) return;
+
+    QModelIndexList persistent = this->beginLayoutMove();
+    qsizetype count = moves.size();
+    for (qsizetype i = 0; i < count; ++i) {
+        const NodeMove &move = moves.at(revert ? count - i - 1 : i);
+        Node *pNode = this->nodeFromHandle(revert ? move.toParent : move.fromParent);
+        Node *tNode = this->nodeFromHandle(revert ? move.fromParent : move.toParent);
+        Node *mNode = m_tree->node(move.handle);
+        if (!pNode || !tNode || !mNode || mNode->parent() != pNode) {
+            qWarning() << "Skipping inconsistent move of node" << move.handle;
+            continue;
+        }
+        this->moveNode(mNode, tNode, revert ? move.fromRow : move.toRow, nullptr);
+    }
+    if (revert) {
+        for (const NodeLevel &level : levels) {
+            Node *node = m_tree->node(level.handle);
+            if (node) node->setItemLevel(level.itemLevel);
+        }
+    }
+    this->endLayoutMove(persistent);
+}
+
+/**!
+ * @brief Create the nodes of a list of records in one model transaction.
+ *
+ * The records must be in pre-order, and the top level records must all have
+ * the same parent and consecutive rows, as made by cloneNodes() or when
+ * loading a project. The new rows are announced once, so no change
+ * notifications are queued for the new nodes.
+ *
+ * @param records The records of the nodes to create.
+ * @return bool   True if the nodes were created.
+ */
+bool ProjectModel::insertRecords(const QList<NodeRecord> &records) {
+
+    if (records.isEmpty()) return false;
+
+    const QUuid parent = records.first().parent;
+    Node *pNode = this->nodeFromHandle(parent);
+    if (!pNode) {
+        qWarning() << "Cannot insert nodes, parent not found";
+        return false;
+    }
+
+    int count = 0;
+    for (const NodeRecord &record : records) {
+        if (record.parent == parent) count++;
+    }
+
+    int first = qMin(qMax(records.first().row, 0), pNode->childCount());
+    int next = first;
+    QHash<QUuid, Node*> created;
+    created.reserve(records.size());
+
+    m_inserting = true;
+    emit beginInsertRows(this->indexFromNode(pNode), first, first + count - 1);
+    for (const NodeRecord &record : records) {
+        bool top = record.parent == parent;
+        Node *rNode = top ? pNode : created.value(record.parent);
+        if (!rNode) continue;
+
+        Node *node = nullptr;
+        if (record.itemType == ItemType::RootType) {
+            node = rNode->createRoot(record.handle, record.name, record.itemClass);
+        } else if (record.itemType == ItemType::FolderType) {
+            node = rNode->createFolder(record.handle, record.name);
+        } else {
+            node = rNode->createFile(record.handle, record.name, record.itemLevel);
+        }
+        rNode->addChild(node, top ? next++ : -1);
+        node->setActive(record.active);
+        node->setCounts(record.counts);
+        node->setExpanded(record.expanded);
+        created.insert(record.handle, node);
+    }
+    emit endInsertRows();
+    m_inserting = false;
+
+    // The sub tree counts of the existing ancestors may have changed
+    for (Node *node = pNode; node && node != m_root; node = node->parent()) {
+        this->queueChanged(node);
+    }
+    return true;
+}
+
+/**!
+ * @brief Remove and delete the nodes created from a list of records.
+ *
+ * If the top level nodes are still next to each other, they are removed in
+ * one model transaction.
+ *
+ * @param records The records the nodes were created from.
+ * @return bool   True if the nodes were removed.
+ */
+bool ProjectModel::removeRecords(const QList<NodeRecord> &records) {
+
+    if (records.isEmpty()) return false;
+
+    const QUuid parent = records.first().parent;
+    Node *pNode = this->nodeFromHandle(parent);
+    if (!pNode) return false;
+
+    QList<Node*> nodes;
+    for (const NodeRecord &record : records) {
+        if (record.parent != parent) continue;
+        Node *node = m_tree->node(record.handle);
+        if (node && node->parent() == pNode) nodes.append(node);
+    }
+    if (nodes.isEmpty()) return false;
+
+    int first = nodes.first()->row();
+    bool contiguous = true;
+    for (qsizetype i = 0; i < nodes.size() && contiguous; ++i) {
+        contiguous = pNode->child(first + i) == nodes.at(i);
+    }
+
+    if (contiguous) {
+        emit beginRemoveRows(this->indexFromNode(pNode), first, first + nodes.size() - 1);
+        for (qsizetype i = 0; i < nodes.size(); ++i) {
+            pNode->takeChild(first);
+        }
+        emit endRemoveRows();
+        for (Node *node : std::as_const(nodes)) {
+            this->releaseNode(node);
+        }
+    } else {
+        for (Node *node : std::as_const(nodes)) {
+            this->deleteNode(node->handle());
+        }
+    }
+    return true;
+}
+
+// Change Notification
+// ===================
+
+/**!
+ * @brief Queue a change notification for a node.
+ *
+ * Changes are collected and sent as dataChanged signals the next time the
+ * event loop runs, so any number of edits to a node in the same pass only
+ * result in one signal.
+ *
+ * @param node The node that has changed.
+ */
+void ProjectModel::queueChanged(Node *node) {
+    if (m_inserting || !node || node == m_root) return;
+    m_changed.insert(node->handle());
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, &ProjectModel::flushChanged, Qt::QueuedConnection);
+    }
+}
+
 // Drag and Drop
 // =============
 
@@ -533,4 +1170,197 @@ QList<QUuid> ProjectModel::decodeMimeHandles(const QMimeData *mimeData) {
     return handles;
 }
 
+// Public Slots
+// ============
+
+/**!
+ * @brief Tell the views that all item icons have changed.
+ *
+ * The nodes do not store their icons, so a single change signal spanning the
+ * top level items is enough for the views to repaint with the new icons.
+ */
+void ProjectModel::refreshDecorations() {
+    int rows = m_root->childCount();
+    if (rows > 0) {
+        emit dataChanged(index(0, 0), index(rows - 1, columnCount() - 1), {Qt::DecorationRole});
+    }
+}
+
+// Private Methods
+// ===============
+
+/**!
+ * @brief Check if an undo command, or any of its children, refers to any of
+ * a set of nodes.
+ *
+ * @param command The command to check.
+ * @param handles The handles of the nodes.
+ * @return bool   True if the command refers to one of the nodes.
+ */
+bool ProjectModel::commandTouches(const QUndoCommand *command, const QSet<QUuid> &handles) {
+    if (!command) return false;
+    auto pCommand = dynamic_cast<const ProjectCommand*>(command);
+    if (pCommand && pCommand->touches(handles)) return true;
+    for (int i = 0; i < command->childCount(); ++i) {
+        if (ProjectModel::commandTouches(command->child(i), handles)) return true;
+    }
+    return false;
+}
+
+/**!
+ * @brief Delete a node that has been taken out of the tree.
+ *
+ * The descendants of the node are also removed from the tree's node map.
+ * The handles of all the deleted nodes are announced with nodesRemoved.
+ *
+ * @param node The node to delete.
+ */
+void ProjectModel::releaseNode(Node *node) {
+    QList<QUuid> removed = {node->handle()};
+    for (Node *cNode : node->allChildren()) {
+        m_tree->removeNode(cNode->handle());
+        m_sortKeys.remove(cNode->handle());
+        removed.append(cNode->handle());
+    }
+    m_sortKeys.remove(node->handle());
+    delete node;
+    emit nodesRemoved(removed);
+}
+
+/**!
+ * @brief Start a layout change for moving nodes.
+ *
+ * @return QModelIndexList The persistent indexes before the change.
+ */
+QModelIndexList ProjectModel::beginLayoutMove() {
+    emit layoutAboutToBeChanged();
+    return this->persistentIndexList();
+}
+
+/**!
+ * @brief Finish a layout change for moving nodes.
+ *
+ * The persistent indexes are mapped to the new rows of their nodes. The rows
+ * are looked up once per parent node rather than once per index.
+ *
+ * @param persistent The persistent indexes from before the change.
+ */
+void ProjectModel::endLayoutMove(const QModelIndexList &persistent) {
+
+    QHash<const Node*, int> rows;
+    QSet<const Node*> parents;
+    QModelIndexList updated;
+    updated.reserve(persistent.size());
+    for (const QModelIndex &index : persistent) {
+        Node *node = static_cast<Node*>(index.internalPointer());
+        Node *pNode = node ? node->parent() : nullptr;
+        if (!pNode) {
+            updated.append(QModelIndex());
+            continue;
+        }
+        if (!parents.contains(pNode)) {
+            for (int i = 0; i < pNode->childCount(); ++i) {
+                rows.insert(pNode->child(i), i);
+            }
+            parents.insert(pNode);
+        }
+        updated.append(createIndex(rows.value(node), index.column(), node));
+    }
+    this->changePersistentIndexList(persistent, updated);
+    emit layoutChanged();
+}
+
+/**!
+ * @brief Move a single node within a layout change.
+ *
+ * @param node   The node to move.
+ * @param target The new parent node.
+ * @param pos    The position under the new parent.
+ * @param levels If not null, the previous levels of nodes whose level changed.
+ * @return qsizetype The row of the node under its new parent.
+ */
+qsizetype ProjectModel::moveNode(Node *node, Node *target, qsizetype pos, QList<NodeLevel> *levels) {
+
+    Node *pNode = node->parent();
+    pNode->takeChild(node->row());
+
+    qsizetype row = qMin(qMax(pos, 0), target->childCount());
+    QList<Node*> nodes = node->allChildren();
+    nodes.prepend(node);
+    QList<ItemLevel> before;
+    if (levels) {
+        before.reserve(nodes.size());
+        for (const Node *mNode : std::as_const(nodes)) before.append(mNode->itemLevel());
+    }
+
+    target->addChild(node, row);
+    for (Node *cNode : node->allChildren()) {
+        cNode->updateValues();
+    }
+    if (levels) {
+        for (qsizetype i = 0; i < nodes.size(); ++i) {
+            if (nodes.at(i)->itemLevel() != before.at(i)) {
+                levels->append({nodes.at(i)->handle(), before.at(i)});
+            }
+        }
+    }
+    return row;
+}
+
+// Private Slots
+// =============
+
+/**!
+ * @brief Send the queued change notifications.
+ *
+ * The changed nodes are grouped by parent, and each run of adjacent rows
+ * under a parent is sent as one dataChanged signal covering all columns.
+ */
+void ProjectModel::flushChanged() {
+
+    m_flushQueued = false;
+    if (m_changed.isEmpty()) return;
+
+    QHash<Node*, QSet<Node*>> groups;
+    for (const QUuid &handle : std::as_const(m_changed)) {
+        Node *node = m_tree->node(handle);
+        if (node && node->parent()) {
+            groups[node->parent()].insert(node);
+        }
+    }
+    m_changed.clear();
+
+    int lastColumn = this->columnCount() - 1;
+    for (auto [pNode, nodes] : groups.asKeyValueRange()) {
+
+        // Skip nodes that are no longer attached to the project tree
+        Node *top = pNode;
+        while (top->parent()) top = top->parent();
+        if (top != m_root) continue;
+
+        // For a few nodes, looking up the rows is cheapest. For many, a
+        // single pass over the children avoids a search per node.
+        QList<int> rows;
+        if (nodes.size() < 8) {
+            for (Node *node : nodes) rows.append(node->row());
+            std::sort(rows.begin(), rows.end());
+        } else {
+            for (int i = 0; i < pNode->childCount(); ++i) {
+                if (nodes.contains(pNode->child(i))) rows.append(i);
+            }
+        }
+
+        qsizetype i = 0;
+        while (i < rows.size()) {
+            qsizetype j = i;
+            while (j + 1 < rows.size() && rows.at(j + 1) == rows.at(j) + 1) ++j;
+            emit dataChanged(
+                createIndex(rows.at(i), 0, pNode->child(rows.at(i))),
+                createIndex(rows.at(j), lastColumn, pNode->child(rows.at(j)))
+            );
+            i = j + 1;
+        }
+    }
+}
+
 } // namespace Collett
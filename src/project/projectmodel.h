@@ -26,12 +26,18 @@
 #include "node.h"
 
 #include <QAbstractItemModel>
+#include <QByteArray>
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QHash>
 #include <QJsonObject>
 #include <QList>
 #include <QMimeData>
 #include <QModelIndex>
+#include <QSet>
 #include <QString>
 #include <QStringList>
+#include <QUndoStack>
 #include <QUuid>
 
 namespace Collett {
@@ -48,10 +54,12 @@ public:
     // Getters
     Node *invisibleRoot() const {return m_root;};
     Node *rootNode(Node *node);
+    Node *trashRoot();
+    QUndoStack *undoStack() const {return m_undoStack;};
+    Tree *tree() const {return m_tree;};
 
     // Methods
     void pack(QJsonObject &data);
-    void unpack(const QJsonObject &data);
 
     // Model Access
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
@@ -59,20 +67,44 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role) const override;
+    void multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const override;
+    QHash<int, QByteArray> roleNames() const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
     QList<QModelIndex> allExpanded();
     Node *nodeAtIndex(const QModelIndex &index);
+    Node *nodeFromHandle(const QUuid &uuid);
+    QModelIndex indexFromNode(Node *node);
     QModelIndex indexFromHandle(const QUuid &uuid);
 
     // Model Edit
     void  insertChild(Node *child, const QModelIndex &parent, qsizetype pos = -1);
     Node *removeChild(const QModelIndex &parent, qsizetype pos);
     void  multiMove(const QModelIndexList &indexes, const QModelIndex &parent, qsizetype pos = -1);
+    bool  sortChildren(const QModelIndex &parent, SortKey sortKey, Qt::SortOrder order = Qt::AscendingOrder);
 
     Node *addRoot(QString name, ItemClass itemClass, const QModelIndex &selected);
     Node *addFolder(QString name, const QModelIndex &selected);
     Node *addFile(QString name, ItemLevel itemLevel, const QModelIndex &selected);
+    void  renameNode(Node *node, const QString &name);
+    bool  cloneNodes(const QList<QUuid> &handles, const QUuid &parent, qsizetype pos);
+    bool  trashNodes(const QList<QUuid> &handles);
+    int   destroyNodes(const QList<QUuid> &handles);
+
+    // Command Methods
+    // These are called by the undo commands, and are not recorded themselves.
+    Node *createNode(const NodeRecord &record);
+    bool  deleteNode(const QUuid &handle);
+    void  setNodeName(const QUuid &handle, const QString &name);
+    void  setChildOrder(const QUuid &parent, const QList<QUuid> &order);
+    void  moveNodes(const QList<QUuid> &handles, const QUuid &parent, qsizetype pos, QList<NodeMove> &moves, QList<NodeLevel> &levels);
+    void  applyMoves(const QList<NodeMove> &moves, const QList<NodeLevel> &levels, bool revert);
+    bool  insertRecords(const QList<NodeRecord> &records);
+    bool  removeRecords(const QList<NodeRecord> &records);
+
+    // Change Notification
+    void queueChanged(Node *node);
+    void dropSortKey(const QUuid &handle) {m_sortKeys.remove(handle);};
 
     // Drag and Drop
     QStringList mimeTypes() const;
@@ -84,9 +116,36 @@ public:
     // Static Methods
     static QList<QUuid> decodeMimeHandles(const QMimeData *mimeData);
 
+signals:
+    void nodesRemoved(const QList<QUuid> &handles);
+
+public slots:
+    void refreshDecorations();
+
+private slots:
+    void flushChanged();
+
 private:
-    Node *m_root = nullptr;
-    Tree *m_tree = nullptr;
+    Node       *m_root = nullptr;
+    Tree       *m_tree = nullptr;
+    QUndoStack *m_undoStack = nullptr;
+
+    // Change Batching
+    QSet<QUuid> m_changed;
+    bool        m_flushQueued = false;
+    bool        m_inserting = false;
+
+    // Sorting
+    QCollator                      m_collator;
+    QHash<QUuid, QCollatorSortKey> m_sortKeys;
+
+    // Methods
+    QModelIndexList beginLayoutMove();
+    void endLayoutMove(const QModelIndexList &persistent);
+    qsizetype moveNode(Node *node, Node *target, qsizetype pos, QList<NodeLevel> *levels);
+    void releaseNode(Node *node);
+
+    static bool commandTouches(const QUndoCommand *command, const QSet<QUuid> &handles);
 
 };
 } // namespace Collett
@@ -22,7 +22,12 @@
 #include "tree.h"
 #include "projectmodel.h"
 
+#include <QBitArray>
+#include <QFile>
+#include <QFuture>
 #include <QJsonObject>
+#include <QStringList>
+#include <QtConcurrent>
 #include <QString>
 
 using namespace Qt::Literals::StringLiterals;
@@ -49,11 +54,20 @@ void Tree::pack(QJsonObject &data) {
     if (m_model) m_model->pack(data);
 }
 
-void Tree::unpack(const QJsonObject &data) {
-    if (m_model) {
-        qDebug() << "Unpacking project tree";
-        m_model->unpack(data);
+/**!
+ * @brief Get the name index of the project tree.
+ *
+ * The index is rebuilt when nodes have been added, removed or renamed since
+ * it was last built.
+ *
+ * @return const NameIndex& The name index.
+ */
+const NameIndex &Tree::nameIndex() {
+    if (m_nameRevision != m_revision || (m_nameIndex.size() == 0 && !m_nodes.isEmpty())) {
+        if (m_model) m_nameIndex.build(m_model->invisibleRoot()->allChildren());
+        m_nameRevision = m_revision;
     }
+    return m_nameIndex;
 }
 
 // Data Methods
@@ -65,7 +79,26 @@ void Tree::unpack(const QJsonObject &data) {
  * @param node The node to be added to the map.
  */
 void Tree::addNode(Node *node) {
-    if (node) m_nodes.insert(node->handle(), node);
+    if (node) {
+        m_nodes.insert(node->handle(), node);
+        m_revision++;
+        if (node->slot() < 0) {
+            qsizetype slot;
+            if (!m_freeSlots.isEmpty()) {
+                slot = m_freeSlots.takeLast();
+            } else {
+                slot = m_slotNodes.size();
+                m_slotNodes.append(nullptr);
+                if (slot >= m_usedBits.size()) {
+                    this->growBits(qMax<qsizetype>(64, 2*m_usedBits.size()));
+                }
+            }
+            m_slotNodes[slot] = node;
+            m_usedBits.setBit(slot);
+            node->setSlot(slot);
+        }
+        this->updateNodeBits(node);
+    }
 }
 
 /**!
@@ -74,7 +107,147 @@ void Tree::addNode(Node *node) {
  * @param uuid The handle of the node to remove.
  */
 void Tree::removeNode(const QUuid &uuid) {
-    if (m_nodes.contains(uuid)) m_nodes.remove(uuid);
+    Node *node = m_nodes.value(uuid).data();
+    if (node && node->slot() >= 0) {
+        qsizetype slot = node->slot();
+        m_usedBits.clearBit(slot);
+        m_activeBits.clearBit(slot);
+        for (QBitArray &bits : m_classBits) bits.clearBit(slot);
+        for (QBitArray &bits : m_levelBits) bits.clearBit(slot);
+        m_slotNodes[slot] = nullptr;
+        m_freeSlots.append(slot);
+        node->setSlot(-1);
+        m_bitsRevision++;
+    }
+    if (m_nodes.remove(uuid)) m_revision++;
+}
+
+/**!
+ * @brief Report that the data of a node has changed.
+ *
+ * @param node The node that changed.
+ */
+void Tree::nodeChanged(Node *node) {
+    if (m_model && node) m_model->queueChanged(node);
+}
+
+/**!
+ * @brief Update the class, level and active bits of a node.
+ *
+ * @param node The node to update.
+ */
+void Tree::updateNodeBits(Node *node) {
+    if (!node || node->slot() < 0) return;
+
+    qsizetype slot = node->slot();
+    for (QBitArray &bits : m_classBits) bits.clearBit(slot);
+    for (QBitArray &bits : m_levelBits) bits.clearBit(slot);
+
+    int itemClass = node->itemClass();
+    int itemLevel = node->itemLevel();
+    if (itemClass >= 0 && itemClass < TREE_CLASS_COUNT) {
+        m_classBits[itemClass].setBit(slot);
+    }
+    if (node->isFileType() && itemLevel >= 0 && itemLevel < TREE_LEVEL_COUNT) {
+        m_levelBits[itemLevel].setBit(slot);
+    }
+    m_activeBits.setBit(slot, node->isActive());
+    m_bitsRevision++;
+}
+
+/**!
+ * @brief Report that a node has been renamed.
+ *
+ * @param node The node that was renamed.
+ */
+void Tree::nodeRenamed(Node *node) {
+    if (node) {
+        m_revision++;
+        if (m_model) m_model->dropSortKey(node->handle());
+        this->nodeChanged(node);
+    }
+}
+
+// Filter Methods
+// ==============
+
+/**!
+ * @brief Compute which nodes are visible with a given filter.
+ *
+ * The matching nodes are found with bitwise operations on whole arrays, after
+ * which the ancestors of each match are added so that the matches can be
+ * reached in the tree.
+ *
+ * @param filter     The filter to apply.
+ * @return QBitArray The visible nodes, indexed by node slot.
+ */
+QBitArray Tree::filterNodes(const NodeFilter &filter) const {
+
+    qsizetype size = m_usedBits.size();
+    QBitArray match = m_usedBits;
+    if (filter.classMask != 0) {
+        QBitArray bits(size);
+        for (int i = 0; i < TREE_CLASS_COUNT; ++i) {
+            if (filter.classMask & (1u << i)) bits |= m_classBits[i];
+        }
+        match &= bits;
+    }
+    if (filter.levelMask != 0) {
+        QBitArray bits(size);
+        for (int i = 0; i < TREE_LEVEL_COUNT; ++i) {
+            if (filter.levelMask & (1u << i)) bits |= m_levelBits[i];
+        }
+        match &= bits;
+    }
+    if (filter.activeOnly) {
+        match &= m_activeBits;
+    }
+
+    QBitArray visible = match;
+    qsizetype count = m_slotNodes.size();
+    for (qsizetype i = 0; i < count; ++i) {
+        if (!match.testBit(i)) continue;
+        Node *node = m_slotNodes.at(i).data();
+        if (!node) continue;
+        // Stop at the first ancestor already visible, as its ancestors are too
+        for (Node *parent = node->parent(); parent && parent->slot() >= 0; parent = parent->parent()) {
+            if (visible.testBit(parent->slot())) break;
+            visible.setBit(parent->slot());
+        }
+    }
+    return visible;
+}
+
+// Static Methods
+// ==============
+
+/**!
+ * @brief Free detached nodes and remove files on a worker thread.
+ *
+ * The nodes, with their sub trees, must already be removed from the model
+ * and the tree, so nothing else refers to them.
+ *
+ * @param nodes The detached nodes to delete.
+ * @param files The files to remove.
+ * @return QFuture<void> The future of the worker task.
+ */
+QFuture<void> Tree::disposeNodes(const QList<Node*> &nodes, const QStringList &files) {
+    return QtConcurrent::run([nodes, files]() {
+        qDeleteAll(nodes);
+        for (const QString &file : files) {
+            if (QFile::exists(file)) QFile::remove(file);
+        }
+    });
+}
+
+// Private Methods
+// ===============
+
+void Tree::growBits(qsizetype size) {
+    m_usedBits.resize(size);
+    m_activeBits.resize(size);
+    for (QBitArray &bits : m_classBits) bits.resize(size);
+    for (QBitArray &bits : m_levelBits) bits.resize(size);
 }
 
 } // namespace Collett
@@ -23,14 +23,23 @@
 #define COLLETT_TREE_H
 
 #include "collett.h"
+#include "nameindex.h"
 #include "node.h"
 #include "projectmodel.h"
+#include "storage.h"
 
+#include <QBitArray>
+#include <QFuture>
 #include <QHash>
+#include <QList>
 #include <QJsonObject>
 #include <QPointer>
+#include <QStringList>
 #include <QUuid>
 
+#define TREE_CLASS_COUNT 9
+#define TREE_LEVEL_COUNT 5
+
 namespace Collett {
 
 class Tree : public QObject
@@ -43,19 +52,51 @@ public:
 
     // Getters
     ProjectModel *model() {return m_model;};
+    Storage *store() const {return m_store;};
     Node *node(const QUuid &uuid) {return m_nodes.value(uuid).data();};
+    const NameIndex &nameIndex();
+    quint64 bitsRevision() const {return m_bitsRevision;};
+
+    // Setters
+    void setStore(Storage *store) {m_store = store;};
 
     // Methods
     void pack(QJsonObject &data);
-    void unpack(const QJsonObject &data);
 
     // Data Methods
     void addNode(Node *node);
     void removeNode(const QUuid &uuid);
+    void nodeChanged(Node *node);
+    void nodeRenamed(Node *node);
+    void updateNodeBits(Node *node);
+
+    // Filter Methods
+    QBitArray filterNodes(const NodeFilter &filter) const;
+
+    // Static Methods
+    static QFuture<void> disposeNodes(const QList<Node*> &nodes, const QStringList &files);
 
 private:
     ProjectModel *m_model;
+    Storage      *m_store = nullptr;
     QHash<QUuid, QPointer<Node> > m_nodes;
+    NameIndex     m_nameIndex;
+    quint64       m_revision = 0;
+    quint64       m_nameRevision = 0;
+
+    // Node Bits
+    // Each node in the tree has a slot, and the bit arrays record the class,
+    // level and active status of the node in that slot.
+    QList<QPointer<Node>> m_slotNodes;
+    QList<qsizetype>      m_freeSlots;
+    QBitArray             m_usedBits;
+    QBitArray             m_activeBits;
+    QBitArray             m_classBits[TREE_CLASS_COUNT];
+    QBitArray             m_levelBits[TREE_LEVEL_COUNT];
+    quint64               m_bitsRevision = 0;
+
+    // Methods
+    void growBits(qsizetype size);
 
 };
 } // namespace Collett
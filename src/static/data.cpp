@@ -52,21 +52,31 @@ SharedData::~SharedData() {
 bool SharedData::openProject(const QString &path) {
 
     m_project.reset(new Project());
-    if (!m_project.data()->hasError()) {
-        m_project.data()->openProject(path);
+    Project *project = m_project.data();
+    connect(project, &Project::loadProgress, this, &SharedData::projectLoadProgress);
+    connect(project, &Project::recountProgress, this, &SharedData::projectRecountProgress);
+    connect(project, &Project::recountFinished, this, &SharedData::projectRecountFinished);
+    connect(project, &Project::loadFinished, this, [this, project](bool success) {
+        if (success) {
+            emit projectLoaded();
+        } else {
+            emit projectLoadFailed(project->lastError());
+        }
+    });
+
+    if (!project->hasError()) {
+        project->openProject(path);
     }
-    if (!m_project.data()->isValid()) {
+    if (!project->isValid()) {
         m_project.reset(nullptr);
         return false;
     }
 
-    emit projectLoaded();
-
     return true;
 }
 
 bool SharedData::saveProject() {
-    if (hasProject()) {
+    if (hasProject() && !m_project.data()->isLoading()) {
         return m_project.data()->saveProject();
     } else {
         return false;
@@ -74,7 +84,7 @@ bool SharedData::saveProject() {
 }
 
 bool SharedData::saveProjectAs(const QString &path) {
-    if (hasProject()) {
+    if (hasProject() && !m_project.data()->isLoading()) {
         return m_project.data()->saveProjectAs(path);
     } else {
         return false;
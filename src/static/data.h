@@ -50,7 +50,11 @@ public:
     Project *project();
 
 signals:
+    void projectLoadProgress(int value, int total);
     void projectLoaded();
+    void projectLoadFailed(const QString &error);
+    void projectRecountProgress(int value, int total);
+    void projectRecountFinished(bool completed);
 
 private:
     static SharedData *staticInstance;
@@ -36,6 +36,7 @@
 using namespace Qt::Literals::StringLiterals;
 
 #define CNF_EDITOR_AUTO_SAVE "Editor/autoSave"_L1
+#define CNF_EDITOR_CACHE_SIZE "Editor/cacheSize"_L1
 #define CNF_MAIN_SPLIT_SIZES "Main/mainSplitSizes"_L1
 #define CNF_MAIN_WINDOW_SIZE "Main/windowSize"_L1
 #define CNF_MAIN_GUI_THEME "Main/guiTheme"_L1
@@ -104,6 +105,7 @@ Settings::Settings(QObject *parent) : QObject(parent) {
     // ---------------
 
     m_editorAutoSave = qMax(settings.value(CNF_EDITOR_AUTO_SAVE, 30).toInt(), 5);
+    m_editorCacheSize = qMax(settings.value(CNF_EDITOR_CACHE_SIZE, 64).toInt(), 1);
 
     // Text Format
     // -----------
@@ -130,6 +132,7 @@ void Settings::flushSettings() {
     settings.setValue(CNF_MAIN_ICON_SET, m_iconSet);
 
     settings.setValue(CNF_EDITOR_AUTO_SAVE, m_editorAutoSave);
+    settings.setValue(CNF_EDITOR_CACHE_SIZE, m_editorCacheSize);
 
     settings.setValue(CNF_TEXT_FONT_SIZE, m_textFontSize);
     settings.setValue(CNF_TEXT_TAB_WIDTH, m_textTabWidth);
@@ -25,6 +25,7 @@
 #include "icons.h"
 
 #include <QString>
+#include <QDir>
 #include <QFileInfo>
 #include <QJsonObject>
 #include <QPalette>
@@ -72,6 +73,8 @@ Theme::Theme(QObject *parent) : QObject(parent) {
     m_baseIconSize = QSize(m_baseIconHeight, m_baseIconHeight);
     m_buttonIconSize = QSize(int(0.9*m_baseIconHeight), int(0.9*m_baseIconHeight));
     m_toolButtonIconSize = QSize(int(1.2*m_baseIconHeight), int(1.2*m_baseIconHeight));
+
+    m_icons->prewarm(m_baseIconSize);
 }
 
 Theme::~Theme() {
@@ -200,4 +203,46 @@ bool Theme::loadTheme(QString theme) {
     return true;
 }
 
+/**!
+ * @brief Switch to another theme while the application is running.
+ *
+ * The palette and theme colours are reloaded, and the icons are retinted
+ * from their cached masks. Widgets that hold on to icons or colours should
+ * refresh them when the themeChanged signal is emitted.
+ *
+ * @param theme The key of the new theme.
+ * @return true if the theme was loaded.
+ */
+bool Theme::switchTheme(QString theme) {
+    if (!this->loadTheme(theme)) {
+        qWarning() << "Could not switch to theme:" << theme;
+        return false;
+    }
+    m_settings->setMainGuiTheme(theme);
+    m_icons->retint();
+    emit themeChanged();
+    return true;
+}
+
+// Static Methods
+// ==============
+
+/**!
+ * @brief List the themes available in the assets folder.
+ *
+ * @return QMap<QString, QString> The theme names, with their keys as map keys.
+ */
+QMap<QString, QString> Theme::availableThemes() {
+    QMap<QString, QString> themes;
+    QDir themesDir = Settings::assetPath("themes");
+    for (const QFileInfo &themeFile : themesDir.entryInfoList({"*.json"}, QDir::Files)) {
+        QJsonObject data;
+        if (JsonUtils::readJson(themeFile.absoluteFilePath(), data, true) == JsonUtilsError::NoError) {
+            QJsonObject jMeta = data.value("c:meta"_L1).toObject();
+            themes[themeFile.baseName()] = JsonUtils::getJsonString(jMeta, "m:name"_L1, themeFile.baseName());
+        }
+    }
+    return themes;
+}
+
 } // namespace Collett
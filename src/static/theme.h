@@ -28,6 +28,7 @@
 
 #include <QColor>
 #include <QList>
+#include <QMap>
 #include <QSize>
 #include <QString>
 
@@ -59,6 +60,13 @@ public:
 
     // Methods
     bool loadTheme(QString theme);
+    bool switchTheme(QString theme);
+
+    // Static Methods
+    static QMap<QString, QString> availableThemes();
+
+signals:
+    void themeChanged();
 
 private:
     static Theme *staticInstance;
@@ -0,0 +1,274 @@
+/*
+** Collett – Counting Kernel Benchmark
+** ===================================
+**
+** This file is a part of Collett
+** Copyright (C) 2025 Veronica Berglyd Olsen
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+
+#include "collett.h"
+#include "counting.h"
+
+#include <QByteArray>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QTextBoundaryFinder>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COUNTING_X86_KERNELS
+#endif
+
+using namespace Qt::Literals::StringLiterals;
+
+namespace Collett {
+
+/**!
+ * @brief Check and benchmark the counting kernels.
+ *
+ * Every kernel the CPU supports is run on the same random paragraphs, in
+ * both encodings, and must give the same word counts as the scalar UTF-16
+ * kernel and as QTextBoundaryFinder, and count the code points. The text
+ * only uses letters for words and white space or dashes between them, where
+ * the two definitions of a word agree.
+ */
+class CountingBench
+{
+public:
+    struct Kernel {
+        const char          *name;
+        Counting::Utf16Kernel utf16;
+        Counting::Utf8Kernel  utf8;
+    };
+
+    struct Result {
+        qint64 words = 0;
+        qint64 chars = 0;
+        qint64 nsecs = 0;
+        qsizetype mismatch = -1;
+        qsizetype differs = -1;
+    };
+
+    static QList<Kernel> kernels();
+    static QStringList paragraphs(QRandomGenerator &random, int count);
+    static qint32 boundaryWords(const QString &text);
+};
+
+QList<CountingBench::Kernel> CountingBench::kernels() {
+    QList<Kernel> kernels = {{"Scalar", &Counting::wordsScalar16, &Counting::wordsScalar8}};
+#ifdef COUNTING_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.append({"SSE2", &Counting::wordsSse2Utf16, &Counting::wordsSse2Utf8});
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.append({"AVX2", &Counting::wordsAvx2Utf16, &Counting::wordsAvx2Utf8});
+    }
+#endif
+    return kernels;
+}
+
+/**!
+ * @brief Make random paragraphs.
+ *
+ * Half of the paragraphs are pure ASCII, so that the vector code is used
+ * for whole blocks. The rest mix in accented, Greek and Cyrillic letters, a
+ * letter outside the BMP, and non-ASCII white space and dashes, so that
+ * blocks are handed over to the scalar code at random points.
+ */
+QStringList CountingBench::paragraphs(QRandomGenerator &random, int count) {
+    static const QString ascii = u"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"_s;
+    static const QStringList letters = {
+        u"é"_s, u"ø"_s, u"å"_s, u"ß"_s, u"ñ"_s, u"Ω"_s, u"λ"_s, u"ж"_s, u"Я"_s, QString::fromUcs4(U"\U00010400", 1),
+    };
+    static const QStringList asciiBreaks = {u" "_s, u" "_s, u" "_s, u"  "_s, u"\t"_s, u" \t "_s};
+    static const QStringList otherBreaks = {u"\u00a0"_s, u"\u2003"_s, u" \u2013 "_s, u"\u2014"_s, u" \u2014 "_s};
+
+    QStringList result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        bool mixed = random.bounded(2) == 1;
+        int words = random.bounded(1, 200);
+        QString text;
+        if (random.bounded(4) == 0) text.append(u' ');
+        for (int w = 0; w < words; ++w) {
+            if (w > 0) {
+                const QStringList &breaks = mixed && random.bounded(4) == 0 ? otherBreaks : asciiBreaks;
+                text.append(breaks.at(random.bounded(breaks.size())));
+            }
+            int length = random.bounded(1, 12);
+            for (int c = 0; c < length; ++c) {
+                if (mixed && random.bounded(5) == 0) {
+                    text.append(letters.at(random.bounded(letters.size())));
+                } else {
+                    text.append(ascii.at(random.bounded(ascii.size())));
+                }
+            }
+        }
+        if (random.bounded(4) == 0) text.append(u' ');
+        result.append(text);
+    }
+    return result;
+}
+
+/**!
+ * @brief Count words as the segments QTextBoundaryFinder starts an item at.
+ */
+qint32 CountingBench::boundaryWords(const QString &text) {
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Word, text);
+    qint32 words = 0;
+    for (qsizetype pos = 0; pos >= 0; pos = finder.toNextBoundary()) {
+        if (finder.boundaryReasons() & QTextBoundaryFinder::StartOfItem) words++;
+    }
+    return words;
+}
+
+} // namespace Collett
+
+using namespace Collett;
+
+int main(int argc, char *argv[]) {
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("countbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Check and benchmark the Collett counting kernels.");
+    parser.addHelpOption();
+    QCommandLineOption countOption("count", "The number of paragraphs.", "count", "20000");
+    QCommandLineOption roundsOption("rounds", "The number of timed rounds.", "rounds", "10");
+    QCommandLineOption seedOption("seed", "The random seed.", "seed", "1");
+    parser.addOption(countOption);
+    parser.addOption(roundsOption);
+    parser.addOption(seedOption);
+    parser.process(app);
+
+    int rounds = qMax(1, parser.value(roundsOption).toInt());
+    QRandomGenerator random(parser.value(seedOption).toUInt());
+    const QStringList texts = CountingBench::paragraphs(random, qMax(1, parser.value(countOption).toInt()));
+
+    QList<QByteArray> encoded;
+    qint64 units = 0;
+    qint64 bytes = 0;
+    for (const QString &text : texts) {
+        encoded.append(text.toUtf8());
+        units += text.size();
+        bytes += encoded.last().size();
+    }
+    std::cout << "Paragraphs: " << texts.size() << ", UTF-16 units: " << units << ", UTF-8 bytes: " << bytes << std::endl;
+
+    // Reference counts
+    QList<qint32> expectWords;
+    QList<qint32> expectChars;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; ++r) {
+        expectWords.clear();
+        for (const QString &text : texts) {
+            expectWords.append(CountingBench::boundaryWords(text));
+        }
+    }
+    qint64 boundaryTime = timer.nsecsElapsed() / rounds;
+    for (const QString &text : texts) {
+        expectChars.append(static_cast<qint32>(text.toUcs4().size()));
+    }
+
+    auto report = [](const char *name, const char *encoding, const CountingBench::Result &result, qint64 size) {
+        double speed = result.nsecs > 0 ? 1000.0 * size / result.nsecs : 0.0;
+        std::cout << "  " << name << " " << encoding << ": " << result.words << " words, "
+                  << result.chars << " chars, " << result.nsecs / 1000 << " µs, " << speed << " MB/s";
+        if (result.mismatch >= 0) std::cout << ", MISMATCH in paragraph " << result.mismatch;
+        if (result.differs >= 0) std::cout << ", DIFFERS from scalar in paragraph " << result.differs;
+        std::cout << std::endl;
+    };
+
+    qint64 totalWords = 0;
+    for (qint32 words : expectWords) totalWords += words;
+    CountingBench::Result boundary;
+    boundary.words = totalWords;
+    boundary.nsecs = boundaryTime;
+    report("QTextBoundaryFinder", "UTF-16", boundary, units * 2);
+
+    // The scalar kernel comes first, and the others are compared with it
+    QList<qint32> scalarWords;
+    bool failed = false;
+    for (const CountingBench::Kernel &kernel : CountingBench::kernels()) {
+        CountingBench::Result utf16;
+        CountingBench::Result utf8;
+        for (qsizetype i = 0; i < texts.size(); ++i) {
+            const QString &text = texts.at(i);
+            qint32 surrogates = 0;
+            qint32 words = kernel.utf16(text.utf16(), text.size(), surrogates);
+            qint32 chars = static_cast<qint32>(text.size()) - surrogates;
+            utf16.words += words;
+            utf16.chars += chars;
+            if (utf16.mismatch < 0 && (words != expectWords.at(i) || chars != expectChars.at(i))) {
+                utf16.mismatch = i;
+            }
+            if (scalarWords.size() < texts.size()) {
+                scalarWords.append(words);
+            } else if (utf16.differs < 0 && words != scalarWords.at(i)) {
+                utf16.differs = i;
+            }
+
+            const QByteArray &data = encoded.at(i);
+            chars = 0;
+            words = kernel.utf8(reinterpret_cast<const uchar*>(data.constData()), data.size(), chars);
+            utf8.words += words;
+            utf8.chars += chars;
+            if (utf8.mismatch < 0 && (words != expectWords.at(i) || chars != expectChars.at(i))) {
+                utf8.mismatch = i;
+            }
+            if (utf8.differs < 0 && words != scalarWords.at(i)) {
+                utf8.differs = i;
+            }
+        }
+
+        qint64 sink = 0;
+        timer.restart();
+        for (int r = 0; r < rounds; ++r) {
+            for (const QString &text : texts) {
+                qint32 surrogates = 0;
+                sink += kernel.utf16(text.utf16(), text.size(), surrogates);
+            }
+        }
+        utf16.nsecs = timer.nsecsElapsed() / rounds;
+
+        timer.restart();
+        for (int r = 0; r < rounds; ++r) {
+            for (const QByteArray &data : std::as_const(encoded)) {
+                qint32 chars = 0;
+                sink += kernel.utf8(reinterpret_cast<const uchar*>(data.constData()), data.size(), chars);
+            }
+        }
+        utf8.nsecs = timer.nsecsElapsed() / rounds;
+        if (sink != (utf16.words + utf8.words) * rounds) failed = true;
+
+        report(kernel.name, "UTF-16", utf16, units * 2);
+        report(kernel.name, "UTF-8 ", utf8, bytes);
+        failed = failed || utf16.mismatch >= 0 || utf8.mismatch >= 0 || utf16.differs >= 0 || utf8.differs >= 0;
+    }
+
+    std::cout << (failed ? "FAILED" : "OK") << std::endl;
+    return failed ? 1 : 0;
+}
@@ -20,6 +20,7 @@ along with this program. If not, see <https://www.gnu.org/licenses/>.
 """
 from __future__ import annotations
 
+import struct
 import subprocess
 import sys
 
@@ -28,6 +29,8 @@ from xml.etree import ElementTree as ET
 
 ET.register_namespace("", "http://www.w3.org/2000/svg")
 ROOT_DIR = Path(__file__).parent.parent
+PACK_MAGIC = b"CLTICONS"
+PACK_VERSION = 1
 ICONS = {
     "cls_archive": "archive",
     "cls_character": "team",
@@ -65,7 +68,7 @@ def _fixXml(svg: ET.Element) -> str:
 
 
 def _writeThemeFile(
-    path: Path, name: str, author: str, license: str, icons: dict[str, ET.Element]
+    path: Path, name: str, author: str, license: str, icons: dict[str, str]
 ) -> None:
     """Write an icon theme file."""
     width = max(len(k) for k in ICONS.keys())
@@ -80,12 +83,60 @@ def _writeThemeFile(
         out.write("# Icons\n")
         for key, svg in icons.items():
             padded = f"{key}{padding}"[:width]
-            out.write(f"icon:{padded} = {_fixXml(svg)}\n")
+            out.write(f"icon:{padded} = {svg}\n")
         print(f"- Wrote: {len(icons)} icons")
         print(f"- Target: {path.relative_to(ROOT_DIR)}")
     return
 
 
+def _writePackFile(
+    path: Path, name: str, author: str, license: str, icons: dict[str, str]
+) -> None:
+    """Write a binary icon pack file.
+
+    The pack holds the same data as the text file, but laid out so that
+    it can be memory mapped and indexed without parsing. All integers
+    are unsigned 32 bit little endian, and all strings are UTF-8.
+
+    Offset  Size  Content
+    0       8     Magic bytes "CLTICONS"
+    8       4     Format version
+    12      4     Number of icons
+    16      8     Name (offset, length)
+    24      8     Author (offset, length)
+    32      8     License (offset, length)
+    40      16*N  Icons, sorted by key (key offset, key length, svg offset, svg length)
+    ...           String table followed by the SVG blobs
+    """
+    keys = sorted(icons.keys())
+    strings = [name, author, license] + keys
+    blobs = [icons[k] for k in keys]
+
+    offset = 40 + 16*len(keys)
+    table = bytearray()
+    spans = []
+    for value in strings + blobs:
+        data = value.encode("utf-8")
+        spans.append((offset + len(table), len(data)))
+        table.extend(data)
+
+    meta = spans[:3]
+    keySpans = spans[3:3+len(keys)]
+    svgSpans = spans[3+len(keys):]
+
+    with open(path.with_suffix(".iconpack"), mode="wb") as out:
+        out.write(PACK_MAGIC)
+        out.write(struct.pack("<II", PACK_VERSION, len(keys)))
+        for span in meta:
+            out.write(struct.pack("<II", *span))
+        for keySpan, svgSpan in zip(keySpans, svgSpans):
+            out.write(struct.pack("<IIII", *keySpan, *svgSpan))
+        out.write(table)
+        print(f"- Packed: {len(keys)} icons")
+        print(f"- Target: {path.with_suffix('.iconpack').relative_to(ROOT_DIR)}")
+    return
+
+
 def _cloneRepo(repoPath: Path, repoUrl: str) -> None:
     """Clone or update a local repo of icons."""
     print(f"Updating: {repoUrl}")
@@ -108,7 +159,7 @@ def processRemix(workDir: Path, iconsDir: Path, jobs: dict) -> None:
 
         print(f"Processing: {name}")
 
-        icons: dict[str, ET.Element] = {}
+        icons: dict[str, str] = {}
         iconSrc = srcRepo / "icons"
         iconGroups = [x for x in iconSrc.iterdir() if x.is_dir()]
         for key, icon in ICONS.items():
@@ -130,10 +181,11 @@ def processRemix(workDir: Path, iconsDir: Path, jobs: dict) -> None:
                     print(f"Not Found: {fileName}")
                     continue
 
-            icons[key] = ET.fromstring(iconFile.read_text(encoding="utf-8"))
+            icons[key] = _fixXml(ET.fromstring(iconFile.read_text(encoding="utf-8")))
 
         target = iconsDir / f"{file}.icons"
         _writeThemeFile(target, name, "Remix Icon", "Apache 2.0", icons)
+        _writePackFile(target, name, "Remix Icon", "Apache 2.0", icons)
 
     print("")
 